@@ -0,0 +1,34 @@
+#include <iostream>
+
+#include "utils.hpp"
+#include "graph.hpp"
+
+using namespace std;
+
+// Converts a Matrix Market file into the binary CSR format:
+//   YAGkP_convert <input.mtx> <output.bcsr> [--ignore-eweights]
+// The result is loaded with Graph<int_t, real_t>(output, "bcsr").
+int main(int argc, char* argv[]) {
+
+    if (argc < 3 || argc > 4 || (argc == 4 && String(argv[3]) != "--ignore-eweights")) {
+        cerr << "Usage: " << argv[0] << " <input.mtx> <output.bcsr> [--ignore-eweights]\n";
+        return 1;
+    }
+
+    const String input_name = argv[1];
+    const String output_name = argv[2];
+    const bool ignore_eweights = (argc == 4);
+
+    try {
+        Graph<int_t, real_t> g(input_name, "mtx", ignore_eweights);
+        g.saveBinary(output_name);
+
+        cout << output_name << ": n = " << g.getVerticesCount() << ", m = " << g.getEdgesCount() << "\n";
+    }
+    catch (const std::exception& error) {
+        cerr << error.what() << "\n";
+        return 1;
+    }
+
+    return 0;
+}
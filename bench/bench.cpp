@@ -0,0 +1,438 @@
+#include <algorithm>
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <sys/resource.h>
+#endif
+
+#include "config.hpp"
+
+#include "utils.hpp"
+
+#include "graph.hpp"
+#include "partitioner.hpp"
+#include "padded_adjacency.hpp"
+#include "metrics.hpp"
+
+using namespace std;
+
+// Benchmark of the partitioning pipeline, phase by phase:
+//   YAGkP_bench [--data <folder>] [--k <k1,k2,...>] [--repetitions <count>]
+//               [--threads <count>] [--format csv|json] [--output <file>]
+//
+// For every graph of the folder the reading of the .mtx file and of its
+// binary CSR copy is timed. For every k the phases of the first bisection
+// (coarsening, initial bisection, uncoarsening) are timed separately, then
+// the whole partitioning without post-processing and the post-processing
+// of its result. Every phase is repeated; the median and the minimum time,
+// the throughput (edges of the input graph per second of the median time)
+// and the peak resident memory of the process are reported. The peak is not
+// reset between records: it covers everything the process did so far,
+// including the previous graphs, so it only grows along the output. Run one
+// graph per process to get the peak of a single graph.
+//
+// The matching sweep of heavy edge and heavy clique matching (without the
+// two-hop pairs and the contraction of the level) is also timed on every
+// level of their hierarchies (for k = 2): on the CSR graph, and on the padded
+// adjacency with each instruction set that the processor supports. The build
+// of the padded adjacency, which every level pays once, is reported as
+// "matching_*_padded_build". The "matching_*" records have the level, its
+// vertices and edges, and the sweeps have the speedup over the CSR sweep.
+
+struct BenchmarkOptions {
+    PartitionerOptions partitioner;
+
+    String         data_folder = YAGKP_DATA_DIR;
+    Vector<int_t>  ks = { 2_i, 4_i, 8_i, 16_i, 32_i, 64_i };
+    int_t          repetitions = 5_i;
+    String         format = "csv";
+    String         output;
+};
+
+struct BenchmarkRecord {
+    String graph;
+    int_t  n = 0_i;
+    int_t  m = 0_i;
+    int_t  k = 0_i;   // 0 for the phases that do not depend on k
+    String phase;
+    int_t  level = 0_i;   // coarse level of the "matching_*" phases, 0 otherwise
+
+    real_t median_ms = 0.0_r;
+    real_t min_ms = 0.0_r;
+    real_t edges_per_second = 0.0_r;
+    real_t process_peak_rss_mb = 0.0_r;   // peak of the whole process until this record
+
+    // Quality of the final partition, only for the "post_processing" phase
+    bool   has_quality = false;
+    real_t edge_cut = 0.0_r;
+    real_t imbalance = 0.0_r;
+
+    // Median time of the CSR scan over the median time, only for the "matching_*" phases
+    bool   has_speedup = false;
+    real_t speedup = 0.0_r;
+};
+
+// Peak resident memory of the process since its start
+real_t GetProcessPeakRSSMegabytes() {
+#ifdef _WIN32
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return c<real_t>(counters.PeakWorkingSetSize) / (1024.0_r * 1024.0_r);
+    }
+    return 0.0_r;
+#else
+    rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return c<real_t>(usage.ru_maxrss) / (1024.0_r * 1024.0_r);   // bytes
+#else
+    return c<real_t>(usage.ru_maxrss) / 1024.0_r;                // kilobytes
+#endif
+#endif
+}
+
+// Times `run` `repetitions` times, `setup` is called before every run and is not timed
+template <typename Setup, typename Run>
+Vector<real_t> Measure(int_t repetitions, Setup&& setup, Run&& run) {
+    Vector<real_t> times;
+    for (int_t r = 0_i; r < repetitions; ++r) {
+        setup();
+        auto start = chrono::steady_clock::now();
+        run();
+        auto finish = chrono::steady_clock::now();
+        times.push_back(chrono::duration<real_t, milli>(finish - start).count());
+    }
+    return times;
+}
+
+template <typename Run>
+Vector<real_t> Measure(int_t repetitions, Run&& run) {
+    return Measure(repetitions, []() {}, run);
+}
+
+BenchmarkRecord MakeRecord(const String& graph, int_t n, int_t m, int_t k, const String& phase, Vector<real_t> times) {
+    sort(times.begin(), times.end());
+
+    BenchmarkRecord record;
+    record.graph = graph;
+    record.n = n;
+    record.m = m;
+    record.k = k;
+    record.phase = phase;
+    record.min_ms = times.front();
+    record.median_ms = (times.size() % 2 == 1)
+        ? times[times.size() / 2]
+        : (times[times.size() / 2 - 1] + times[times.size() / 2]) / 2.0_r;
+    record.edges_per_second = (record.median_ms > 0.0_r) ? c<real_t>(m) / (record.median_ms / 1000.0_r) : 0.0_r;
+    record.process_peak_rss_mb = GetProcessPeakRSSMegabytes();
+    return record;
+}
+
+// Times the matching sweep of `method` on every level of its hierarchy
+void BenchmarkMatching(
+    const String& name,
+    const Graph<int_t, real_t>& g,
+    ProgramConfig::CoarseningMethod method,
+    const String& method_name,
+    const BenchmarkOptions& options,
+    Vector<BenchmarkRecord>& records
+) {
+    const int_t k = 2_i;
+    const bool heavy_edge = (method == ProgramConfig::CoarseningMethod::HeavyEdgeMatching);
+
+    PartitionerOptions csr = options.partitioner;
+    csr.coarsening_method = method;
+    csr.coarsening_parallel_matching = false;
+    csr.coarsening_padded_adjacency = false;
+
+    Vector<ProgramConfig::InstructionSet> sets;
+    for (ProgramConfig::InstructionSet set : { ProgramConfig::InstructionSet::Scalar, ProgramConfig::InstructionSet::AVX2, ProgramConfig::InstructionSet::AVX512 }) {
+        if (MaskedArgMax::Resolve(set) == set) {
+            sets.push_back(set);
+        }
+    }
+
+    SetRandomSeed(1);
+    Vector<CoarseLevel<int_t, real_t>> levels = Coarser::GetCoarseLevels(g, k, csr);
+
+    for (size_t lvl = 0; lvl + 1 < levels.size(); ++lvl) {
+        const CoarseLevel<int_t, real_t>& level = levels[lvl];
+        const Graph<int_t, real_t>& level_graph = level.getGraph();
+        const int_t n = level_graph.getVerticesCount();
+        const int_t max_allowed_size = Coarser::GetMaxAllowedSize(level_graph, k, csr);
+
+        Vector<int_t> permutation;
+        Vector<int_t> matching;
+        Vector<real_t> matching_edge_weights;
+        auto reset = [&]() {
+            SetRandomSeed(1);
+            GetRandomPermutation(n, permutation);
+            matching.assign(n, -1_i);
+            matching_edge_weights.assign(n, 0.0_r);
+        };
+
+        auto addRecord = [&](const String& variant, const Vector<real_t>& times) -> BenchmarkRecord& {
+            records.push_back(MakeRecord(name, n, level_graph.getEdgesCount(), k, "matching_" + method_name + "_" + variant, times));
+            records.back().level = c<int_t>(lvl) + 1_i;
+            return records.back();
+        };
+        auto setSpeedup = [](BenchmarkRecord& record, real_t csr_median_ms) {
+            record.has_speedup = true;
+            record.speedup = (record.median_ms > 0.0_r) ? csr_median_ms / record.median_ms : 0.0_r;
+        };
+
+        BenchmarkRecord& csr_record = addRecord("csr", Measure(options.repetitions, reset, [&]() {
+            if (heavy_edge) {
+                Coarser::HeavyEdgeSweep(level_graph, permutation, max_allowed_size, matching, matching_edge_weights);
+            }
+            else {
+                Coarser::HeavyCliqueSweep(level, level_graph, permutation, max_allowed_size, matching, matching_edge_weights);
+            }
+        }));
+        const real_t csr_median_ms = csr_record.median_ms;
+        setSpeedup(csr_record, csr_median_ms);
+
+        // The copy is built once per level, before every padded sweep of the level
+        PaddedAdjacency adjacency;
+        addRecord("padded_build", Measure(options.repetitions, [&]() {
+            if (heavy_edge) {
+                adjacency.build(level_graph, Coarser::GetHeavyEdgeRating<real_t>());
+            }
+            else {
+                adjacency.build(level_graph, Coarser::GetHeavyCliqueRating(level, level_graph));
+            }
+        }));
+        if (!adjacency.isOrdered()) {
+            continue;
+        }
+
+        for (ProgramConfig::InstructionSet set : sets) {
+            BenchmarkRecord& record = addRecord(String("padded_") + MaskedArgMax::GetName(set), Measure(options.repetitions, reset, [&]() {
+                Coarser::PaddedSweep(level_graph, adjacency, set, permutation, max_allowed_size, matching, matching_edge_weights);
+            }));
+            setSpeedup(record, csr_median_ms);
+        }
+    }
+}
+
+void BenchmarkGraph(const String& path, const BenchmarkOptions& options, Vector<BenchmarkRecord>& records) {
+    const String name = filesystem::path(path).stem().string();
+    const int_t repetitions = options.repetitions;
+    const PartitionerOptions& partitioner = options.partitioner;
+
+    Graph<int_t, real_t> g;
+
+    Vector<real_t> mtx_times = Measure(repetitions, [&]() {
+        g = Graph<int_t, real_t>(path, "mtx", true, partitioner.threads_count);
+    });
+    const int_t n = g.getVerticesCount();
+    const int_t m = g.getEdgesCount();
+    records.push_back(MakeRecord(name, n, m, 0_i, "io_mtx", mtx_times));
+
+    const String binary_path = (filesystem::temp_directory_path() / (name + ".yagkp_bench.bcsr")).string();
+    g.saveBinary(binary_path);
+    Vector<real_t> bcsr_times = Measure(repetitions, [&]() {
+        Graph<int_t, real_t> binary_graph(binary_path, "bcsr");
+    });
+    filesystem::remove(binary_path);
+    records.push_back(MakeRecord(name, n, m, 0_i, "io_bcsr", bcsr_times));
+
+    for (int_t k : options.ks) {
+        if (k > n) {
+            continue;
+        }
+
+        // Phases of the first bisection
+        Vector<CoarseLevel<int_t, real_t>> levels;
+        Vector<real_t> coarsening_times = Measure(repetitions,
+            [&]() { levels.clear(); },
+            [&]() { levels = Coarser::GetCoarseLevels(g, k, partitioner); }
+        );
+        records.push_back(MakeRecord(name, n, m, k, "coarsening", coarsening_times));
+
+        Vector<int_t> coarse_partition;
+        Vector<real_t> bisection_times = Measure(repetitions, [&]() {
+            Bipartitioner::GetGraphBipartition(levels.back().getGraph(), coarse_partition, partitioner);
+        });
+        records.push_back(MakeRecord(name, n, m, k, "initial_bisection", bisection_times));
+
+        Vector<int_t> partition;
+        Vector<real_t> uncoarsening_times = Measure(repetitions,
+            [&]() { partition = coarse_partition; },
+            [&]() { Uncoarser::RestorePartition<int_t, real_t>(levels, partition, partitioner); }
+        );
+        records.push_back(MakeRecord(name, n, m, k, "uncoarsening", uncoarsening_times));
+
+        levels.clear();
+
+        // The whole k-way partitioning, then its post-processing
+        PartitionerOptions raw_partitioner = partitioner;
+        raw_partitioner.post_processing_disbalance_fix = false;
+        raw_partitioner.post_processing_improvement = false;
+
+        Vector<int_t> raw_partition;
+        Vector<real_t> partitioning_times = Measure(repetitions, [&]() {
+            Partitioner::GetGraphKPartition(g, k, raw_partition, raw_partitioner);
+        });
+        records.push_back(MakeRecord(name, n, m, k, "partitioning", partitioning_times));
+
+        Vector<real_t> post_processing_times = Measure(repetitions,
+            [&]() { partition = raw_partition; },
+            [&]() {
+                PostProcessor::FixPartitionDisbalance<int_t, real_t>(g, k, partition, partitioner);
+                PostProcessor::ImproveFinalPartition<int_t, real_t>(g, k, partition, partitioner);
+            }
+        );
+        BenchmarkRecord record = MakeRecord(name, n, m, k, "post_processing", post_processing_times);
+        record.has_quality = true;
+        record.edge_cut = PartitionMetrics::GetEdgeCut(g, partition);
+        record.imbalance = PartitionMetrics::GetAccuracy(g, k, partition);
+        records.push_back(record);
+    }
+
+    BenchmarkMatching(name, g, ProgramConfig::CoarseningMethod::HeavyEdgeMatching, "hem", options, records);
+    BenchmarkMatching(name, g, ProgramConfig::CoarseningMethod::HeavyCliqueMatching, "hcm", options, records);
+}
+
+void WriteCSV(ostream& out, const Vector<BenchmarkRecord>& records) {
+    out << "graph,n,m,k,phase,level,median_ms,min_ms,edges_per_second,process_peak_rss_mb,edge_cut,imbalance,speedup\n";
+    for (const BenchmarkRecord& record : records) {
+        out << record.graph << "," << record.n << "," << record.m << "," << record.k << "," << record.phase << "," << record.level << ","
+            << record.median_ms << "," << record.min_ms << "," << record.edges_per_second << "," << record.process_peak_rss_mb << ",";
+        if (record.has_quality) {
+            out << record.edge_cut << "," << record.imbalance;
+        }
+        else {
+            out << ",";
+        }
+        out << ",";
+        if (record.has_speedup) {
+            out << record.speedup;
+        }
+        out << "\n";
+    }
+}
+
+void WriteJSON(ostream& out, const Vector<BenchmarkRecord>& records) {
+    out << "[\n";
+    for (size_t i = 0; i < records.size(); ++i) {
+        const BenchmarkRecord& record = records[i];
+        out << "  {\"graph\": \"" << record.graph << "\", \"n\": " << record.n << ", \"m\": " << record.m
+            << ", \"k\": " << record.k << ", \"phase\": \"" << record.phase << "\", \"level\": " << record.level
+            << ", \"median_ms\": " << record.median_ms << ", \"min_ms\": " << record.min_ms
+            << ", \"edges_per_second\": " << record.edges_per_second << ", \"process_peak_rss_mb\": " << record.process_peak_rss_mb;
+        if (record.has_quality) {
+            out << ", \"edge_cut\": " << record.edge_cut << ", \"imbalance\": " << record.imbalance;
+        }
+        if (record.has_speedup) {
+            out << ", \"speedup\": " << record.speedup;
+        }
+        out << "}" << (i + 1 < records.size() ? "," : "") << "\n";
+    }
+    out << "]\n";
+}
+
+Vector<int_t> ParseKs(const String& list) {
+    Vector<int_t> ks;
+    stringstream stream(list);
+    String item;
+    while (getline(stream, item, ',')) {
+        ks.push_back(stoll(item));
+    }
+    return ks;
+}
+
+int main(int argc, char* argv[]) {
+
+    ios_base::sync_with_stdio(false);
+
+    BenchmarkOptions options;
+
+    options.partitioner.coarsening_method = ProgramConfig::CoarseningMethod::HeavyCliqueMatching;
+    options.partitioner.bipartitioning_method = ProgramConfig::BipartitioningMethod::GreedyGraphGrowingAlgorithm;
+    options.partitioner.uncoarsening_method = ProgramConfig::UncoarseningMethod::KernighanLin;
+
+    options.partitioner.coarsening_clusterization_prohibition = true;
+    options.partitioner.coarsening_clusterization_size_factor = 0.9_r;
+
+    options.partitioner.accuracy = 0.050_r;
+
+    try {
+        for (int i = 1; i < argc; ++i) {
+            const String argument = argv[i];
+            if (i + 1 >= argc) {
+                throw runtime_error("Missing value of " + argument);
+            }
+            const String value = argv[++i];
+
+            if (argument == "--data") {
+                options.data_folder = value;
+            }
+            else if (argument == "--k") {
+                options.ks = ParseKs(value);
+            }
+            else if (argument == "--repetitions") {
+                options.repetitions = max(1_i, c<int_t>(stoll(value)));
+            }
+            else if (argument == "--threads") {
+                options.partitioner.threads_count = max(1_i, c<int_t>(stoll(value)));
+            }
+            else if (argument == "--format") {
+                if (value != "csv" && value != "json") {
+                    throw runtime_error("Unknown format " + value);
+                }
+                options.format = value;
+            }
+            else if (argument == "--output") {
+                options.output = value;
+            }
+            else {
+                throw runtime_error("Unknown argument " + argument);
+            }
+        }
+
+        Vector<String> files = GetFileNames(options.data_folder, ".mtx");
+        sort(files.begin(), files.end());
+
+        Vector<BenchmarkRecord> records;
+        for (const String& path : files) {
+            cerr << "Benchmarking " << path << "\n";
+            BenchmarkGraph(path, options, records);
+        }
+
+        ofstream file;
+        if (!options.output.empty()) {
+            file.open(options.output);
+            if (!file) {
+                throw runtime_error("Can't open file " + options.output);
+            }
+        }
+        ostream& out = options.output.empty() ? cout : file;
+        out << setprecision(6);
+
+        if (options.format == "json") {
+            WriteJSON(out, records);
+        }
+        else {
+            WriteCSV(out, records);
+        }
+    }
+    catch (const exception& error) {
+        cerr << error.what() << "\n";
+        cerr << "Usage: " << argv[0] << " [--data <folder>] [--k <k1,k2,...>] [--repetitions <count>]"
+             << " [--threads <count>] [--format csv|json] [--output <file>]\n";
+        return 1;
+    }
+
+    return 0;
+}
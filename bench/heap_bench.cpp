@@ -0,0 +1,91 @@
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <random>
+
+#include "types.hpp"
+#include "utils.hpp"
+
+#include "heap.hpp"
+#include "bucket_queue.hpp"
+
+// Microbenchmark of the indexed priority queues on a refinement-like
+// workload: all vertices are pushed, a number of gain updates follows and
+// the queue is drained. The best time over the repetitions is printed.
+
+// Keeps the extracted indices alive, so the workload is not optimized out
+volatile int_t sink = 0;
+
+struct Operation {
+    int_t value;
+    int_t index;
+};
+
+template <typename Heap>
+real_t RunWorkload(Heap& heap, const Vector<Operation>& initial, const Vector<Operation>& updates) {
+    auto start = std::chrono::steady_clock::now();
+
+    for (const Operation& op : initial) {
+        heap.push(op.value, op.index);
+    }
+    int_t checksum = 0;
+    for (int_t i = 0; i < c<int_t>(updates.size()); ++i) {
+        const Operation& op = updates[i];
+        heap.push(op.value, op.index);
+        // Moving a vertex takes the best one out, as KL and FM do
+        if (i % 8 == 7 && !heap.empty()) {
+            checksum += heap.extract().second;
+        }
+    }
+    while (!heap.empty()) {
+        checksum += heap.extract().second;
+    }
+
+    auto finish = std::chrono::steady_clock::now();
+
+    sink = checksum;
+    return std::chrono::duration<real_t, std::milli>(finish - start).count();
+}
+
+template <typename Heap>
+void Measure(const String& name, int_t n, const Vector<Operation>& initial, const Vector<Operation>& updates, int_t repetitions) {
+    Heap heap(n);
+    real_t best_time = std::numeric_limits<real_t>::max();
+    for (int_t r = 0; r < repetitions; ++r) {
+        heap.clear();
+        best_time = std::min(best_time, RunWorkload(heap, initial, updates));
+    }
+    std::cout << std::setw(24) << std::left << name << " n = " << std::setw(9) << n
+              << " | " << std::fixed << std::setprecision(3) << best_time << " ms\n";
+}
+
+int main() {
+    const int_t repetitions = 5;
+    const int_t max_gain = 64;
+
+    std::mt19937 gen(42);
+
+    for (int_t n : {10'000LL, 100'000LL, 1'000'000LL}) {
+        std::uniform_int_distribution<int_t> gain(-max_gain, max_gain);
+        std::uniform_int_distribution<int_t> vertex(0, n - 1);
+
+        Vector<Operation> initial(n);
+        for (int_t v = 0; v < n; ++v) {
+            initial[v] = { gain(gen), v };
+        }
+        Vector<Operation> updates(4 * n);
+        for (Operation& op : updates) {
+            op = { gain(gen), vertex(gen) };
+        }
+
+        Measure<IndexedHeap<int_t, std::greater<int_t>>>("IndexedHeap", n, initial, updates, repetitions);
+        Measure<DaryIndexedHeap<int_t, std::greater<int_t>, 2>>("DaryIndexedHeap<2>", n, initial, updates, repetitions);
+        Measure<DaryIndexedHeap<int_t, std::greater<int_t>, 4>>("DaryIndexedHeap<4>", n, initial, updates, repetitions);
+        Measure<DaryIndexedHeap<int_t, std::greater<int_t>, 8>>("DaryIndexedHeap<8>", n, initial, updates, repetitions);
+        Measure<BucketQueue<int_t, std::greater<int_t>>>("BucketQueue", n, initial, updates, repetitions);
+        std::cout << "\n";
+    }
+
+    return 0;
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <type_traits>
+
+#include "utils.hpp"
+
+// Binary CSR graph format (.bcsr).
+//
+// Layout (little-endian, every section starts at a multiple of 8 bytes):
+//   BinaryGraphHeader
+//   xadj           - (n + 1) x int64
+//   adjncy         - m x vertex id type
+//   vertex_weights - n x vertex weight type
+//   edge_weights   - m x edge weight type
+//
+// The checksum covers everything after the header, so a truncated or
+// damaged file is rejected instead of producing a broken graph.
+//
+
+inline constexpr char BINARY_GRAPH_MAGIC[8] = { 'Y', 'A', 'G', 'k', 'P', 'C', 'S', 'R' };
+inline constexpr std::uint32_t BINARY_GRAPH_VERSION = 2u;
+
+struct BinaryGraphHeader {
+	char		  magic[8];
+	std::uint32_t version;
+	std::uint32_t header_size;
+	std::uint32_t vertex_id_type;
+	std::uint32_t reserved;
+	std::uint32_t vertex_weight_type;
+	std::uint32_t edge_weight_type;
+	std::int64_t  n;
+	std::int64_t  m;
+	std::uint64_t payload_size;
+	std::uint64_t checksum;
+};
+
+static_assert(sizeof(BinaryGraphHeader) % 8 == 0, "BinaryGraphHeader must keep the sections aligned");
+
+// Type tag stored in the header: size in bytes plus a bit for floating point types.
+template <typename T>
+constexpr std::uint32_t GetBinaryTypeTag() {
+	static_assert(std::is_arithmetic_v<T>, "Only arithmetic weights can be stored in the binary format");
+	return static_cast<std::uint32_t>(sizeof(T)) | (std::is_floating_point_v<T> ? 0x100u : 0u);
+}
+
+constexpr std::uint64_t GetBinarySectionSize(std::uint64_t bytes) {
+	return (bytes + 7u) & ~std::uint64_t(7u);
+}
+
+/*
+ * Computes the checksum of a memory block.
+ *
+ * The block is processed by 8-byte words mixed with MixBits, the tail
+ * is padded with zeros. Passing the result of the previous call as `hash`
+ * gives the checksum of the concatenation of 8-byte padded blocks.
+ *
+ * Parameters:
+ * - data - pointer to the first byte	| ex: mapped_file.data() + sizeof(BinaryGraphHeader)
+ * - size - number of bytes				| ex: 4096
+ * - hash - checksum of the previous blocks | ex: 0
+ *
+ * Returns:
+ * - std::uint64_t - the checksum
+ */
+std::uint64_t GetChecksum(const void* data, std::size_t size, std::uint64_t hash = 0);
+
+// Read-only memory mapping of a whole file (mmap on POSIX, MapViewOfFile on Windows).
+// Throws std::runtime_error if the file cannot be opened or mapped.
+class MappedFile {
+private:
+
+	const std::byte* mapped_data = nullptr;
+	std::size_t		 mapped_size = 0;
+
+#ifdef _WIN32
+	void* file_handle = nullptr;
+	void* mapping_handle = nullptr;
+#endif
+
+public:
+
+	explicit MappedFile(const String& file_name);
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	~MappedFile();
+
+	const std::byte* data() const noexcept {
+		return mapped_data;
+	}
+
+	std::size_t size() const noexcept {
+		return mapped_size;
+	}
+};
@@ -1,62 +1,182 @@
 #pragma once
 
-#include <queue>
+#include "config.hpp"
 
 #include "utils.hpp"
 #include "graph.hpp"
 
 #include "heap.hpp"
+#include "instrumentation.hpp"
+#include "bucket_queue.hpp"
+#include "metrics.hpp"
+#include "thread_pool.hpp"
+#include "workspace.hpp"
+
+// Bipartitioning method as a type, see the specializations after Bipartitioner
+template <ProgramConfig::BipartitioningMethod method>
+struct BipartitioningStrategy;
 
 class Bipartitioner {
 public:
 
-    template <typename vw_t, typename ew_t>
+    template <typename InitialPartitioner, typename vw_t, typename ew_t, typename idx_t>
+    static void GetGraphBipartition(
+        const Graph<vw_t, ew_t, idx_t>& graph,
+              Vector<int_t>&     partition,
+        const PartitionerOptions& options
+    ) {
+        Instrumentation::ScopedTimer timer("initial_bisection");
+
+        partition = InitialPartitioner::GetBipartition(graph, options);
+    }
+
+    // Uses the algorithm of `options.bipartitioning_method`
+    template <typename vw_t, typename ew_t, typename idx_t>
     static void GetGraphBipartition(
-        const Graph<vw_t, ew_t>& graph,
-              Vector<int_t>&     partition
+        const Graph<vw_t, ew_t, idx_t>& graph,
+              Vector<int_t>&     partition,
+        const PartitionerOptions& options = PartitionerOptions()
     ) {
-        switch (ProgramConfig::bipartitioning_method) {
+        VisitBipartitioningStrategy(options.bipartitioning_method, [&]<typename InitialPartitioner>() {
+            GetGraphBipartition<InitialPartitioner>(graph, partition, options);
+        });
+	}
+
+    // The only runtime dispatch on the bipartitioning method:
+    // returns `function.template operator()<BipartitioningStrategy<method>>()`
+    template <typename Function>
+    static decltype(auto) VisitBipartitioningStrategy(ProgramConfig::BipartitioningMethod method, Function&& function) {
+        switch (method) {
         case ProgramConfig::BipartitioningMethod::GraphGrowingAlgorithm:
-            partition = GraphGrowingAlgorithm(graph);
-            break;
+            return function.template operator()<BipartitioningStrategy<ProgramConfig::BipartitioningMethod::GraphGrowingAlgorithm>>();
         case ProgramConfig::BipartitioningMethod::GreedyGraphGrowingAlgorithm:
-            partition = GreedyGraphGrowingAlgorithm(graph);
-            break;
+            return function.template operator()<BipartitioningStrategy<ProgramConfig::BipartitioningMethod::GreedyGraphGrowingAlgorithm>>();
 
         default:
-            throw std::runtime_error("Unknown bipartitioning method in ProgramConfig.");
+            throw std::runtime_error("Unknown bipartitioning method in PartitionerOptions.");
         }
+    }
 
-	}
-
+    // Buffers of one launch. Every concurrently running launch owns
+    // a separate instance, which is reused by its subsequent launches.
+    // The buffers are borrowed from the workspace of the calling thread.
     template <typename vw_t, typename ew_t>
-    static Vector<int_t> GraphGrowingAlgorithm(
-        const Graph<vw_t, ew_t>& graph
+    struct LaunchScratch {
+        Workspace::Buffer<int_t>                       partition;
+        Workspace::Buffer<bool>                        visited;
+        Workspace::Buffer<int_t>                       order;
+        Workspace::Buffer<int_t>                       queue;
+        Workspace::Buffer<ew_t>                        gain;
+        Workspace::HeapBuffer<GainPriorityQueue<ew_t>> heap;
+        ew_t                                           edge_cut = c<ew_t>(0);
+
+        explicit LaunchScratch(int_t n):
+            heap(n)
+        {}
+    };
+
+    // Runs `launches_count` independent launches of an initial partitioning algorithm
+    // and returns the partition with the minimum edge cut.
+    //
+    // Launches are executed in batches of `options.threads_count` in parallel.
+    // Each launch has its own random seed and results are reduced in launch order,
+    // so the answer does not depend on the number of threads. If
+    // `bipartitioning_launches_without_improvement_limit` is positive, the search stops
+    // after that many consecutive launches without improving the best edge cut.
+    template <typename vw_t, typename ew_t, typename idx_t, typename Launch>
+    static Vector<int_t> MultiStart(
+        const Graph<vw_t, ew_t, idx_t>& graph,
+        const int_t              launches_count,
+        const Launch&            launch,
+        const PartitionerOptions& options
     ) {
-        const int_t n = graph.n;
+        std::shared_ptr<ThreadPool> pool = ThreadPool::GetInstance(options.threads_count);
 
-        vw_t total_weight = graph.getSumOfVertexWeights();
+        const int_t batch_size = std::max(1_i, std::min(pool->getThreadsCount(), launches_count));
+        const int_t no_improvement_limit = options.bipartitioning_launches_without_improvement_limit;
 
-        vw_t ideal_weight = total_weight / c<vw_t>(2);
-        vw_t max_allowed = (ProgramConfig::accuracy + 1.0_r) * ideal_weight;
+        const std::uint64_t launches_seed = GetRandomSeed();
+
+        Vector<LaunchScratch<vw_t, ew_t>> scratches;
+        scratches.reserve(batch_size);
+        for (int_t i = 0_i; i < batch_size; ++i) {
+            scratches.emplace_back(graph.n);
+        }
 
         Vector<int_t> best_partition;
-        ew_t best_edge_cut;
+        ew_t best_edge_cut = c<ew_t>(0);
 
         bool found = false;
+        int_t launches_without_improvement = 0_i;
+        int_t launches_done = 0_i;
 
-        for (int_t i = 0_i; i < ProgramConfig::bipartitioning_GraphGrowingAlgorithm_launches_count; ++i) {
+        auto report = [&]() {
+            Instrumentation::Count("launches", c<real_t>(launches_done));
+            if (found) {
+                Instrumentation::Sample("best_cut", c<real_t>(best_edge_cut));
+            }
+        };
+
+        for (int_t first = 0_i; first < launches_count; first += batch_size) {
+            const int_t current_batch_size = std::min(batch_size, launches_count - first);
+
+            pool->ParallelFor(0_i, current_batch_size, 1_i, [&](int_t i) {
+                ScopedRandomSeed seed(DeriveRandomSeed(launches_seed, first + i));
+
+                LaunchScratch<vw_t, ew_t>& scratch = scratches[i];
+                launch(scratch);
+                scratch.edge_cut = PartitionMetrics::GetEdgeCut(graph, scratch.partition.get());
+            });
+
+            for (int_t i = 0_i; i < current_batch_size; ++i) {
+                ++launches_done;
+                if (!found || scratches[i].edge_cut < best_edge_cut) {
+                    found = true;
+                    best_partition = scratches[i].partition.get();
+                    best_edge_cut = scratches[i].edge_cut;
+                    launches_without_improvement = 0_i;
+                }
+                else if (no_improvement_limit > 0_i && ++launches_without_improvement >= no_improvement_limit) {
+                    report();
+                    return best_partition;
+                }
+            }
+        }
+        report();
+        return best_partition;
+    }
 
-            Vector<int_t> partition(n, 0_i);
-            Vector<bool> visited(n, false);
+    template <typename vw_t, typename ew_t, typename idx_t>
+    static Vector<int_t> GraphGrowingAlgorithm(
+        const Graph<vw_t, ew_t, idx_t>& graph,
+        const PartitionerOptions& options
+    ) {
+        const int_t n = graph.n;
 
-            std::queue<int_t> q;
+        vw_t total_weight = graph.getSumOfVertexWeights();
+
+        vw_t ideal_weight = total_weight / c<vw_t>(2);
+        vw_t max_allowed = (options.accuracy + 1.0_r) * ideal_weight;
+
+        auto launch = [&](LaunchScratch<vw_t, ew_t>& scratch) {
+            Vector<int_t>& partition = scratch.partition.get();
+            Vector<bool>& visited = scratch.visited.get();
+            Vector<int_t>& order = scratch.order.get();
 
-            Vector<int_t> order = GetRandomPermutation(n);
+            partition.assign(n, 0_i);
+            visited.assign(n, false);
+
+            // Every vertex is pushed at most once, so a vector with
+            // a read position is enough for the BFS queue
+            Vector<int_t>& q = scratch.queue.get();
+            q.clear();
+            int_t q_head = 0_i;
+
+            GetRandomPermutation(n, order);
 
             for (int_t start_V : order) {
                 if (graph.vertex_weights[start_V] <= max_allowed) {
-                    q.push(start_V);
+                    q.push_back(start_V);
                     partition[start_V] = 1_i;
                     visited[start_V] = true;
                     break;
@@ -65,8 +185,8 @@ public:
 
             vw_t current_weight = c<vw_t>(0);
 
-            while (!q.empty()) {
-                int_t curr_V = q.front(); q.pop();
+            while (q_head < static_cast<int_t>(q.size())) {
+                int_t curr_V = q[q_head++];
 
                 if (current_weight + graph.vertex_weights[curr_V] > max_allowed) {
                     continue;
@@ -78,45 +198,58 @@ public:
                 for (auto [next_V, w] : graph[curr_V]) {
                     if (!visited[next_V]) {
                         visited[next_V] = true;
-                        q.push(next_V);
+                        q.push_back(next_V);
                     }
                 }
             }
+        };
 
-            ew_t edge_cut = PartitionMetrics::GetEdgeCut(graph, partition);
-
-            if (!found || edge_cut < best_edge_cut) {
-                found = true;
-                best_partition = partition;
-                best_edge_cut = edge_cut;
-            }
-        }
-        return best_partition;
+        return MultiStart(graph, options.bipartitioning_GraphGrowingAlgorithm_launches_count, launch, options);
     }
 
-    template <typename vw_t, typename ew_t>
+    template <typename vw_t, typename ew_t, typename idx_t>
     static Vector<int_t> GreedyGraphGrowingAlgorithm(
-        const Graph<vw_t, ew_t>& graph
+        const Graph<vw_t, ew_t, idx_t>& graph,
+        const PartitionerOptions& options
     ) {
         const int_t n = graph.n;
 
         vw_t ideal_weight = graph.getSumOfVertexWeights() / c<vw_t>(2);
-        vw_t max_allowed = (ProgramConfig::accuracy + 1.0_r) * ideal_weight;
+        vw_t max_allowed = (options.accuracy + 1.0_r) * ideal_weight;
+
+        // Total weight of the edges incident to every vertex
+        Workspace::Buffer<ew_t> degree_weight_buffer(n, c<ew_t>(0));
+        Vector<ew_t>& degree_weight = degree_weight_buffer.get();
+        for (int_t curr_V = 0_i; curr_V < n; ++curr_V) {
+            for (auto [next_V, w] : graph[curr_V]) {
+                degree_weight[curr_V] += w;
+            }
+        }
 
-        Vector<int_t> best_partition;
-        ew_t best_edge_cut;
+        // gain[V] = (weight of edges from V to part 0) - (weight of edges from V to part 1)
+        // is maintained for every vertex: when a vertex joins part 1, the gain of each
+        // of its neighbours drops by twice the weight of the connecting edge.
+        auto move_to_part1 = [&](int_t V, Vector<int_t>& partition, Vector<ew_t>& gain) {
+            partition[V] = 1_i;
+            for (auto [next_V, w] : graph[V]) {
+                gain[next_V] -= c<ew_t>(2) * w;
+            }
+        };
 
-        bool found = false;
+        auto launch = [&](LaunchScratch<vw_t, ew_t>& scratch) {
+            Vector<int_t>& partition = scratch.partition.get();
+            Vector<bool>& blocked = scratch.visited.get();
+            Vector<int_t>& order = scratch.order.get();
+            Vector<ew_t>& gain = scratch.gain.get();
 
-        for (int_t i = 0_i; i < ProgramConfig::bipartitioning_GreedyGraphGrowingAlgorithm_launches_count; ++i) {
+            partition.assign(n, 0_i);
+            blocked.assign(n, false);
+            gain = degree_weight;
 
-            Vector<int_t> partition(n, 0_i);
-			Vector<bool> blocked(n, false);
-            
             vw_t current_weight = c<vw_t>(0);
-			IndexedHeap<ew_t> heap(n); // sort values in increasing order by value
+            GainPriorityQueue<ew_t>& heap = scratch.heap.get(); // sort values in increasing order by value
 
-			Vector<int_t> order = GetRandomPermutation(n);
+            GetRandomPermutation(n, order);
 
             bool flag = true;
             while (flag) {
@@ -125,23 +258,18 @@ public:
                 for (int_t V: order) {
                     if (!blocked[V] && graph.getVertexWeight(V) + current_weight <= max_allowed) {
                         flag = true;
-                        partition[V] = 1_i;
                         blocked[V] = true;
+                        move_to_part1(V, partition, gain);
 
+                        // Only the edge to the new seed is counted as the part 1 weight here
                         for (auto [next_V, w1] : graph[V]) {
-                            ew_t inc_w = c<ew_t>(0);
-                            ew_t dec_w = w1;
-                            for (auto [near_V, w2] : graph[next_V]) {
-                                if (partition[near_V] == 0_i) {
-                                    inc_w += w2;
-                                }
-                            }
-                            heap.push(inc_w - dec_w, next_V);
+                            ew_t inc_w = (gain[next_V] + degree_weight[next_V]) / c<ew_t>(2);
+                            heap.push(inc_w - w1, next_V);
                         }
 
                         break;
                     }
-				}
+                }
 
                 while (!heap.empty()) {
                     auto [priority, curr_V] = heap.extract();
@@ -154,34 +282,39 @@ public:
 
                     current_weight += graph.vertex_weights[curr_V];
 
-                    partition[curr_V] = 1_i;
+                    move_to_part1(curr_V, partition, gain);
                     for (auto [next_V, w1] : graph[curr_V]) {
                         if (blocked[next_V]) continue;
-                        ew_t inc_w = c<ew_t>(0);
-                        ew_t dec_w = c<ew_t>(0);
-
-                        for (auto [near_V, w2] : graph[next_V]) {
-                            if (partition[near_V] == 0_i) {
-                                inc_w += w2;
-                            }
-                            else if (partition[near_V] == 1_i) {
-                                dec_w += w2;
-                            }
-                        }
-
-                        heap.push(inc_w - dec_w, next_V);
+                        heap.push(gain[next_V], next_V);
                     }
                 }
             }
+        };
 
-            ew_t edge_cut = PartitionMetrics::GetEdgeCut(graph, partition);
-
-            if (!found || edge_cut < best_edge_cut) {
-                found = true;
-                best_partition = partition;
-                best_edge_cut = edge_cut;
-            }
-        }
-        return best_partition;
+        return MultiStart(graph, options.bipartitioning_GreedyGraphGrowingAlgorithm_launches_count, launch, options);
+    }
+};
+
+// An initial partitioning strategy returns a bipartition of the coarsest graph
+// from GetBipartition(graph, options)
+template <>
+struct BipartitioningStrategy<ProgramConfig::BipartitioningMethod::GraphGrowingAlgorithm> {
+    template <typename vw_t, typename ew_t, typename idx_t>
+    static Vector<int_t> GetBipartition(
+        const Graph<vw_t, ew_t, idx_t>& graph,
+        const PartitionerOptions& options
+    ) {
+        return Bipartitioner::GraphGrowingAlgorithm(graph, options);
+    }
+};
+
+template <>
+struct BipartitioningStrategy<ProgramConfig::BipartitioningMethod::GreedyGraphGrowingAlgorithm> {
+    template <typename vw_t, typename ew_t, typename idx_t>
+    static Vector<int_t> GetBipartition(
+        const Graph<vw_t, ew_t, idx_t>& graph,
+        const PartitionerOptions& options
+    ) {
+        return Bipartitioner::GreedyGraphGrowingAlgorithm(graph, options);
     }
 };
\ No newline at end of file
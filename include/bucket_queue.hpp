@@ -0,0 +1,301 @@
+#pragma once
+
+#include <algorithm>
+#include <functional>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+#include "types.hpp"
+#include "heap.hpp"
+
+// Gain-bucket priority queue with the interface of IndexedHeap.
+//
+// Every integer priority has its own bucket: a doubly linked list of indices
+// stored in arrays. The queue keeps a pointer to the best non-empty bucket,
+// so push, changePriority and the removal of an element are O(1) and
+// extract is O(1) amortized. The bucket range grows on demand up to
+// RANGE_FACTOR times the capacity (refinement gains are bounded by the
+// maximum weighted degree). A wider range of priorities, e.g. with large
+// edge weights, moves the elements to a DaryIndexedHeap, which serves the
+// queue until the next clear().
+//
+// Elements with equal priority are extracted in LIFO order while the
+// buckets are used.
+//
+// Template parameters:
+//   HeapType   - integral priority type
+//   Comparator - std::less (minimum on top) or std::greater (maximum on top)
+//
+template <
+	typename HeapType,
+	typename Comparator = std::less<HeapType>
+>
+class BucketQueue {
+	static_assert(std::is_integral_v<HeapType>, "BucketQueue requires integral priorities");
+	static_assert(
+		std::is_same_v<Comparator, std::less<HeapType>> || std::is_same_v<Comparator, std::greater<HeapType>>,
+		"BucketQueue supports only std::less and std::greater"
+	);
+
+	// The best element has the largest key
+	static constexpr bool max_on_top = std::is_same_v<Comparator, std::greater<HeapType>>;
+
+	static constexpr int_t NONE = -1_i;
+	static constexpr int_t ABSENT = -2_i;
+
+	// Maximum number of buckets is max(MIN_RANGE, RANGE_FACTOR * capacity)
+	static constexpr int_t RANGE_FACTOR = 4_i;
+	static constexpr int_t MIN_RANGE = 1024_i;
+
+	int_t capacity = 0_i;
+	int_t sz = 0_i;
+
+	// Per element: priority and list links, prev is ABSENT for the elements
+	// that are not in the queue
+	std::vector<HeapType> priority;
+	std::vector<int_t>	  next;
+	std::vector<int_t>	  prev;
+
+	// head[b] is the first element of the bucket of key (b + min_key)
+	std::vector<int_t> head;
+	int_t			   min_key = 0_i;
+	int_t			   best = NONE;
+
+	// Holds all elements when their priorities do not fit into the buckets
+	std::optional<DaryIndexedHeap<HeapType, Comparator>> fallback;
+	bool												  use_fallback = false;
+
+	int_t getKey(HeapType value) const {
+		return max_on_top ? static_cast<int_t>(value) : -static_cast<int_t>(value);
+	}
+
+	int_t getMaxRange() const {
+		return std::max(MIN_RANGE, RANGE_FACTOR * capacity);
+	}
+
+	// Makes the buckets cover `key`, doubling the range up to getMaxRange().
+	// Returns false if the range would have to grow beyond it.
+	bool cover(int_t key) {
+		if (head.empty()) {
+			min_key = key;
+			head.assign(1, NONE);
+			return true;
+		}
+
+		const int_t max_key = min_key + static_cast<int_t>(head.size()) - 1_i;
+		if (key >= min_key && key <= max_key) {
+			return true;
+		}
+
+		// The keys can be the whole int_t range apart, the difference is taken
+		// in the unsigned type to avoid an overflow
+		const int_t max_range = getMaxRange();
+		const int_t low = std::min(key, min_key);
+		const int_t high = std::max(key, max_key);
+		if (static_cast<unsigned long long>(high) - static_cast<unsigned long long>(low) >= static_cast<unsigned long long>(max_range)) {
+			return false;
+		}
+
+		const int_t range = static_cast<int_t>(head.size());
+		const int_t new_min_key = (key < min_key) ? std::max(std::min(key, min_key - range), max_key + 1_i - max_range) : min_key;
+		const int_t new_max_key = (key > max_key) ? std::min(std::max(key, max_key + range), min_key - 1_i + max_range) : max_key;
+		const int_t shift = min_key - new_min_key;
+
+		std::vector<int_t> new_head(new_max_key - new_min_key + 1_i, NONE);
+		for (int_t b = 0_i; b < range; ++b) {
+			new_head[b + shift] = head[b];
+		}
+
+		head = std::move(new_head);
+		min_key = new_min_key;
+		if (best != NONE) {
+			best += shift;
+		}
+		return true;
+	}
+
+	// Moves all elements from the buckets to the heap
+	void switchToFallback() {
+		if (!fallback) {
+			fallback.emplace(capacity);
+		}
+		for (int_t b = 0_i; b <= best; ++b) {
+			for (int_t index = head[b]; index != NONE; index = next[index]) {
+				fallback->push(priority[index], index);
+				prev[index] = ABSENT;
+			}
+			head[b] = NONE;
+		}
+		sz = 0_i;
+		best = NONE;
+		use_fallback = true;
+	}
+
+	void link(HeapType value, int_t index) {
+		const int_t key = getKey(value);
+		if (!cover(key)) {
+			switchToFallback();
+			fallback->push(value, index);
+			return;
+		}
+
+		const int_t b = key - min_key;
+
+		priority[index] = value;
+		prev[index] = NONE;
+		next[index] = head[b];
+		if (head[b] != NONE) {
+			prev[head[b]] = index;
+		}
+		head[b] = index;
+
+		if (best == NONE || b > best) {
+			best = b;
+		}
+		++sz;
+	}
+
+	void unlink(int_t index) {
+		const int_t b = getKey(priority[index]) - min_key;
+
+		if (prev[index] != NONE) {
+			next[prev[index]] = next[index];
+		}
+		else {
+			head[b] = next[index];
+		}
+		if (next[index] != NONE) {
+			prev[next[index]] = prev[index];
+		}
+		prev[index] = ABSENT;
+		--sz;
+
+		if (sz == 0_i) {
+			best = NONE;
+		}
+		else {
+			while (head[best] == NONE) {
+				--best;
+			}
+		}
+	}
+
+public:
+
+	BucketQueue() = delete;
+
+	BucketQueue(int_t cap):
+		capacity(cap),
+		priority(cap),
+		next(cap, NONE),
+		prev(cap, ABSENT)
+	{}
+
+	bool empty() const {
+		return use_fallback ? fallback->empty() : sz == 0_i;
+	}
+
+	int_t size() const {
+		return use_fallback ? fallback->size() : sz;
+	}
+
+	int_t getCapacity() const {
+		return capacity;
+	}
+
+	// True while the elements are kept in the DaryIndexedHeap
+	bool usesFallback() const {
+		return use_fallback;
+	}
+
+	bool contains(int_t index) const {
+		if (use_fallback) {
+			return fallback->contains(index);
+		}
+		return index >= 0_i && index < capacity && prev[index] != ABSENT;
+	}
+
+	// Removes all elements in O(size + number of buckets), keeping the memory.
+	// The queue returns to the buckets.
+	void clear() {
+		if (use_fallback) {
+			fallback->clear();
+			use_fallback = false;
+			return;
+		}
+		for (int_t b = 0_i; b <= best; ++b) {
+			for (int_t index = head[b]; index != NONE; index = next[index]) {
+				prev[index] = ABSENT;
+			}
+			head[b] = NONE;
+		}
+		sz = 0_i;
+		best = NONE;
+	}
+
+	void push(HeapType value, int_t index) {
+		if (index < 0_i || index >= capacity) {
+			throw std::runtime_error("Incorrect index in .push operation!");
+		}
+		if (use_fallback) {
+			fallback->push(value, index);
+		}
+		else if (prev[index] != ABSENT) {
+			changePriority(value, index);
+		}
+		else {
+			link(value, index);
+		}
+	}
+
+	std::pair<HeapType, int_t> top() const {
+		if (use_fallback) {
+			return fallback->top();
+		}
+		if (empty()) {
+			throw std::runtime_error("Empty heap!");
+		}
+		const int_t index = head[best];
+		return std::make_pair(priority[index], index);
+	}
+
+	std::pair<HeapType, int_t> extract() {
+		if (use_fallback) {
+			return fallback->extract();
+		}
+		if (empty()) {
+			throw std::runtime_error("Empty heap!");
+		}
+		const int_t index = head[best];
+		unlink(index);
+		return std::make_pair(priority[index], index);
+	}
+
+	void changePriority(HeapType new_priority, int_t index) {
+		if (use_fallback) {
+			fallback->changePriority(new_priority, index);
+			return;
+		}
+		if (!contains(index)) {
+			throw std::runtime_error("No such index in the heap!");
+		}
+		if (priority[index] == new_priority) {
+			return;
+		}
+		unlink(index);
+		link(new_priority, index);
+	}
+};
+
+// Priority queue for gains: buckets for integral gains, a 4-ary heap otherwise
+template <
+	typename HeapType,
+	typename Comparator = std::less<HeapType>
+>
+using GainPriorityQueue = std::conditional_t<
+	std::is_integral_v<HeapType>,
+	BucketQueue<HeapType, Comparator>,
+	DaryIndexedHeap<HeapType, Comparator>
+>;
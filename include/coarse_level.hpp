@@ -3,10 +3,27 @@
 #include "utils.hpp"
 #include "graph.hpp"
 
-template <typename vw_t, typename ew_t>
+template <typename vw_t, typename ew_t, typename idx_t = vid_t>
 struct CoarseLevel {
-	Vector<int_t>		  uncoarse_to_coarse;
-	Vector<Vector<int_t>> coarse_to_uncoarse;
-	Graph<vw_t, ew_t>	  coarsed_graph;
+	// Maps a vertex of the previous (finer) level to its vertex on this level
+	Vector<idx_t>		  uncoarse_to_coarse;
+
+	// Inverse mapping stored in CSR format:
+	//   coarse_to_uncoarse[coarse_to_uncoarse_xadj[c] .. coarse_to_uncoarse_xadj[c+1]-1]
+	//   contains the vertices of the previous level merged into coarse vertex c.
+	// Both mappings are empty for the finest level.
+	Vector<int_t>		  coarse_to_uncoarse_xadj;
+	Vector<idx_t>		  coarse_to_uncoarse;
+
+	// Graph built on this level. The finest level does not own a graph:
+	// it refers to the caller's one through `source_graph`, which must
+	// outlive the level hierarchy.
+	Graph<vw_t, ew_t, idx_t> coarsed_graph;
+	const Graph<vw_t, ew_t, idx_t>* source_graph = nullptr;
+
 	Vector<ew_t>		  vertex_importance;
-};
\ No newline at end of file
+
+	const Graph<vw_t, ew_t, idx_t>& getGraph() const noexcept {
+		return source_graph != nullptr ? *source_graph : coarsed_graph;
+	}
+};
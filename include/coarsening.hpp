@@ -1,5 +1,6 @@
 #pragma once
 
+#include <algorithm>
 #include <numeric>
 
 #include "config.hpp"
@@ -8,93 +9,163 @@
 #include "graph.hpp"
 
 #include "program_statistics.hpp"
+#include "instrumentation.hpp"
 
 #include "coarse_level.hpp"
+#include "padded_adjacency.hpp"
+#include "thread_pool.hpp"
+#include "workspace.hpp"
+
+// Coarsening method as a type, see the specializations after Coarser
+template <ProgramConfig::CoarseningMethod method>
+struct MatchingStrategy;
 
 class Coarser {
 public:
 
-	template <typename vw_t, typename ew_t>
-	Vector<CoarseLevel<vw_t, ew_t>> static GetCoarseLevels(
-		const Graph<vw_t, ew_t>& graph,
-		const int_t k
+	// The first level refers to `graph` without copying it,
+	// so the returned hierarchy must not outlive the graph.
+	// Coarsening stops once the graph has at most `vertices_limit` vertices.
+	//
+	// Every level is built by `Matching::FillLevel`, which is resolved at compile time.
+	template <typename Matching, typename vw_t, typename ew_t, typename idx_t>
+	Vector<CoarseLevel<vw_t, ew_t, idx_t>> static GetCoarseLevels(
+		const Graph<vw_t, ew_t, idx_t>& graph,
+		const int_t k,
+		const int_t vertices_limit,
+		const PartitionerOptions& options
 	) {
-		Vector<CoarseLevel<vw_t, ew_t>> levels;
-		levels.reserve(ProgramConfig::coarsening_itarations_limit + 1_i);
+		Instrumentation::ScopedTimer timer("coarsening");
+
+		Vector<CoarseLevel<vw_t, ew_t, idx_t>> levels;
+		levels.reserve(options.coarsening_itarations_limit + 1_i);
 
 		// Entry-level initialization
-		Vector<int_t> base_uncoarse_to_coarse(graph.n);
-		std::iota(base_uncoarse_to_coarse.begin(), base_uncoarse_to_coarse.end(), 0_i);
+		CoarseLevel<vw_t, ew_t, idx_t> base_level;
+		base_level.source_graph = &graph;
+		base_level.vertex_importance.assign(graph.n, c<ew_t>(0));
 
-		Vector<Vector<int_t>> base_coarse_to_uncoarse(graph.n);
-		for (int_t i = 0_i; i < graph.n; ++i) {
-			base_coarse_to_uncoarse[i] = Vector<int_t>(1_i, i);
-		}
+		levels.push_back(std::move(base_level));
 
-		Vector<ew_t> base_vertex_importance(graph.n, c<ew_t>(0));
+		for (int_t i = 0_i; i < options.coarsening_itarations_limit && levels[i].getGraph().n > vertices_limit; ++i) {
 
-		levels.push_back(CoarseLevel<vw_t, ew_t>(base_uncoarse_to_coarse, base_coarse_to_uncoarse, graph, base_vertex_importance));
+			Instrumentation::ScopedTimer level_timer("level", i + 1_i);
 
-		for (int_t i = 0_i; i < ProgramConfig::coarsening_itarations_limit && levels[i].coarsed_graph.n > ProgramConfig::coarsening_vertix_count_limit; ++i) {
+			CoarseLevel<vw_t, ew_t, idx_t> new_level;
 
-			CoarseLevel<vw_t, ew_t> new_level;
+			Matching::FillLevel(levels[i], levels[i].getGraph(), new_level, k, options);
 
-			FillLevel(levels[i], levels[i].coarsed_graph, new_level, k);
+			levels.push_back(std::move(new_level));
 
-			levels.push_back(new_level);
+			const real_t contraction_ratio = c<real_t>(levels.back().getGraph().n) / c<real_t>(levels[i].getGraph().n);
+
+			if (Instrumentation::IsActive()) {
+				const Graph<vw_t, ew_t, idx_t>& coarse_graph = levels.back().getGraph();
+				Instrumentation::Count("n", c<real_t>(coarse_graph.n));
+				Instrumentation::Count("m", c<real_t>(coarse_graph.m));
+				Instrumentation::Sample("contraction_ratio", contraction_ratio);
+			}
 
 			if (ProgramConfig::collect_mathing_statistics){
-				ProgramStatistics::UpdateMatchingStatistics(new_level.coarsed_graph.vertex_weights, i + 1_i);
+				ProgramStatistics::UpdateMatchingStatistics(levels.back().coarsed_graph.vertex_weights, i + 1_i);
+			}
+
+			// Every further level would cost O(n + m) for almost no reduction
+			if (contraction_ratio > options.coarsening_stall_contraction_ratio) {
+				Instrumentation::Count("stalled");
+				break;
 			}
 		}
 		return std::move(levels);
 	}
 
-	template <typename vw_t, typename ew_t>
+	// Uses the matching of `options.coarsening_method`
+	template <typename vw_t, typename ew_t, typename idx_t>
+	Vector<CoarseLevel<vw_t, ew_t, idx_t>> static GetCoarseLevels(
+		const Graph<vw_t, ew_t, idx_t>& graph,
+		const int_t k,
+		const int_t vertices_limit,
+		const PartitionerOptions& options
+	) {
+		return VisitMatchingStrategy(options.coarsening_method, [&]<typename Matching>() {
+			return GetCoarseLevels<Matching>(graph, k, vertices_limit, options);
+		});
+	}
+
+	// Coarsens down to `options.coarsening_vertix_count_limit` vertices
+	template <typename vw_t, typename ew_t, typename idx_t>
+	Vector<CoarseLevel<vw_t, ew_t, idx_t>> static GetCoarseLevels(
+		const Graph<vw_t, ew_t, idx_t>& graph,
+		const int_t k,
+		const PartitionerOptions& options = PartitionerOptions()
+	) {
+		return GetCoarseLevels(graph, k, options.coarsening_vertix_count_limit, options);
+	}
+
+	template <typename vw_t, typename ew_t, typename idx_t>
 	void static FillLevel(
-		const CoarseLevel<vw_t, ew_t>& level,
-		const Graph<vw_t, ew_t>&	   graph,
-			  CoarseLevel<vw_t, ew_t>& new_level,
-		const int_t                    k
+		const CoarseLevel<vw_t, ew_t, idx_t>& level,
+		const Graph<vw_t, ew_t, idx_t>&	   graph,
+			  CoarseLevel<vw_t, ew_t, idx_t>& new_level,
+		const int_t                    k,
+		const PartitionerOptions&	   options
 	) {
-		switch (ProgramConfig::coarsening_method) {
+		VisitMatchingStrategy(options.coarsening_method, [&]<typename Matching>() {
+			Matching::FillLevel(level, graph, new_level, k, options);
+		});
+	}
+
+	// The only runtime dispatch on the coarsening method:
+	// returns `function.template operator()<MatchingStrategy<method>>()`
+	template <typename Function>
+	static decltype(auto) VisitMatchingStrategy(ProgramConfig::CoarseningMethod method, Function&& function) {
+		switch (method) {
 		case ProgramConfig::CoarseningMethod::RandomMatching:
-			RandomMatching(level, graph, new_level, k);
-			break;
+			return function.template operator()<MatchingStrategy<ProgramConfig::CoarseningMethod::RandomMatching>>();
 
 		case ProgramConfig::CoarseningMethod::LightEdgeMatching:
-			LightEdgeMatching(level, graph, new_level, k);
-			break;
+			return function.template operator()<MatchingStrategy<ProgramConfig::CoarseningMethod::LightEdgeMatching>>();
 
 		case ProgramConfig::CoarseningMethod::HeavyEdgeMatching:
-			HeavyEdgeMatching(level, graph, new_level, k);
-			break;
+			return function.template operator()<MatchingStrategy<ProgramConfig::CoarseningMethod::HeavyEdgeMatching>>();
 
 		case ProgramConfig::CoarseningMethod::HeavyCliqueMatching:
-			HeavyCliqueMatching(level, graph, new_level, k);
-			break;
+			return function.template operator()<MatchingStrategy<ProgramConfig::CoarseningMethod::HeavyCliqueMatching>>();
 
 		default:
-			throw std::runtime_error("Unknown coarsening method in ProgramConfig.");
+			throw std::runtime_error("Unknown coarsening method in PartitionerOptions.");
 		}
 	}
 
-	template <typename vw_t, typename ew_t>
+	template <typename vw_t, typename ew_t, typename idx_t>
 	void static RandomMatching(
-		const CoarseLevel<vw_t, ew_t>& level,
-		const Graph<vw_t, ew_t>&	   graph,
-			  CoarseLevel<vw_t, ew_t>& new_level,
-		const int_t                    k
+		const CoarseLevel<vw_t, ew_t, idx_t>& level,
+		const Graph<vw_t, ew_t, idx_t>&	   graph,
+			  CoarseLevel<vw_t, ew_t, idx_t>& new_level,
+		const int_t                    k,
+		const PartitionerOptions&	   options
 	) {
+		if (options.coarsening_parallel_matching) {
+			// All ratings are equal, so the random tie-breaking decides
+			ParallelMatching(level, graph, new_level, k, [](int_t, int_t, ew_t) {
+				return 0.0_r;
+			}, options);
+			return;
+		}
+
+		Workspace::Buffer<int_t> permutation_buffer;
+		Vector<int_t>& permutation = permutation_buffer.get();
+		GetRandomPermutation(graph.n, permutation);
 
-		Vector<int_t> permutation = GetRandomPermutation(graph.n);
+		Workspace::Buffer<int_t> matching_buffer(graph.n, -1_i);
+		Workspace::Buffer<ew_t> matching_edge_weights_buffer(graph.n, c<ew_t>(0));
 
-		Vector<int_t> matching(graph.n, -1_i);
-		Vector<ew_t> matching_edge_weights(graph.n, c<ew_t>(0));
+		Vector<int_t>& matching = matching_buffer.get();
+		Vector<ew_t>& matching_edge_weights = matching_edge_weights_buffer.get();
 
 		vw_t max_allowed_size = graph.getSumOfVertexWeights();
-		if (!ProgramConfig::coarsening_clusterization_prohibition) {
-			max_allowed_size = c<vw_t>((c<real_t>(max_allowed_size) / c<real_t>(k)) * ProgramConfig::coarsening_clusterization_size_factor);
+		if (!options.coarsening_clusterization_prohibition) {
+			max_allowed_size = c<vw_t>((c<real_t>(max_allowed_size) / c<real_t>(k)) * options.coarsening_clusterization_size_factor);
 		}
 
 		for (int_t curr_V : permutation) {
@@ -110,25 +181,38 @@ public:
 			}
 		}
 
+		TwoHopMatching(graph, k, matching, matching_edge_weights, options);
 		ProcessMatching(level, graph, new_level, matching, matching_edge_weights);
 	}
 
-	template <typename vw_t, typename ew_t>
+	template <typename vw_t, typename ew_t, typename idx_t>
 	void static LightEdgeMatching(
-		const CoarseLevel<vw_t, ew_t>& level,
-		const Graph<vw_t, ew_t>&	   graph,
-			  CoarseLevel<vw_t, ew_t>& new_level,
-		const int_t                    k
+		const CoarseLevel<vw_t, ew_t, idx_t>& level,
+		const Graph<vw_t, ew_t, idx_t>&	   graph,
+			  CoarseLevel<vw_t, ew_t, idx_t>& new_level,
+		const int_t                    k,
+		const PartitionerOptions&	   options
 	) {
+		if (options.coarsening_parallel_matching) {
+			ParallelMatching(level, graph, new_level, k, [](int_t, int_t, ew_t w) {
+				return -c<real_t>(w);
+			}, options);
+			return;
+		}
+
+		Workspace::Buffer<int_t> permutation_buffer;
+		Vector<int_t>& permutation = permutation_buffer.get();
+		GetRandomPermutation(graph.n, permutation);
 
-		Vector<int_t> permutation = GetRandomPermutation(graph.n);
+		Workspace::Buffer<int_t> matching_buffer(graph.n, -1_i);
+		Workspace::Buffer<ew_t> matching_edge_weights_buffer(graph.n, c<ew_t>(0));
 
-		Vector<int_t> matching(graph.n, -1_i);
-		Vector<ew_t> matching_edge_weights(graph.n, c<ew_t>(0));
+		Vector<int_t>& matching = matching_buffer.get();
+		Vector<ew_t>& matching_edge_weights = matching_edge_weights_buffer.get();
 
 		vw_t max_allowed_size = graph.getSumOfVertexWeights();
-		if (!ProgramConfig::coarsening_clusterization_prohibition) {
-			max_allowed_size = c<vw_t>((c<real_t>(max_allowed_size) / c<real_t>(k)) * ProgramConfig::coarsening_clusterization_size_factor);
+		if (!options.coarsening_clusterization_prohibition) {
+			max_allowed_size = c<vw_t>((c<real_t>(max_allowed_size) / c<real_t>(k)) * options.coarsening_clusterization_size_factor);
 		}
 
 		for (int_t curr_V : permutation) {
@@ -156,27 +240,55 @@ public:
 			}
 		}
 
+		TwoHopMatching(graph, k, matching, matching_edge_weights, options);
 		ProcessMatching(level, graph, new_level, matching, matching_edge_weights);
 	}
 
-	template <typename vw_t, typename ew_t>
+	template <typename vw_t, typename ew_t, typename idx_t>
 	void static HeavyEdgeMatching(
-		const CoarseLevel<vw_t, ew_t>& level,
-		const Graph<vw_t, ew_t>&	   graph,
-		CoarseLevel<vw_t, ew_t>&	   new_level,
-		const int_t                    k
+		const CoarseLevel<vw_t, ew_t, idx_t>& level,
+		const Graph<vw_t, ew_t, idx_t>&	   graph,
+		CoarseLevel<vw_t, ew_t, idx_t>&	   new_level,
+		const int_t                    k,
+		const PartitionerOptions&	   options
 	) {
+		if (options.coarsening_parallel_matching) {
+			ParallelMatching(level, graph, new_level, k, GetHeavyEdgeRating<ew_t>(), options);
+			return;
+		}
 
-		Vector<int_t> permutation = GetRandomPermutation(graph.n);
+		if (options.coarsening_padded_adjacency) {
+			const bool done = PaddedMatching(level, graph, new_level, k, GetHeavyEdgeRating<ew_t>(), options);
+			if (done) return;
+		}
 
-		Vector<int_t> matching(graph.n, -1_i);
-		Vector<ew_t> matching_edge_weights(graph.n, c<ew_t>(0));
+		Workspace::Buffer<int_t> permutation_buffer;
+		Vector<int_t>& permutation = permutation_buffer.get();
+		GetRandomPermutation(graph.n, permutation);
 
-		vw_t max_allowed_size = graph.getSumOfVertexWeights();
-		if (!ProgramConfig::coarsening_clusterization_prohibition) {
-			max_allowed_size = c<vw_t>((c<real_t>(max_allowed_size) / c<real_t>(k)) * ProgramConfig::coarsening_clusterization_size_factor);
-		}
+		Workspace::Buffer<int_t> matching_buffer(graph.n, -1_i);
+		Workspace::Buffer<ew_t> matching_edge_weights_buffer(graph.n, c<ew_t>(0));
+
+		Vector<int_t>& matching = matching_buffer.get();
+		Vector<ew_t>& matching_edge_weights = matching_edge_weights_buffer.get();
+
+		HeavyEdgeSweep(graph, permutation, GetMaxAllowedSize(graph, k, options), matching, matching_edge_weights);
+
+		TwoHopMatching(graph, k, matching, matching_edge_weights, options);
+		ProcessMatching(level, graph, new_level, matching, matching_edge_weights);
+	}
 
+	// Matching step of HeavyEdgeMatching: every unmatched vertex, in the order of
+	// `permutation`, is matched with its first unmatched neighbour of the largest
+	// edge weight that keeps the coarse vertex within `max_allowed_size`
+	template <typename vw_t, typename ew_t, typename idx_t>
+	void static HeavyEdgeSweep(
+		const Graph<vw_t, ew_t, idx_t>& graph,
+		const Vector<int_t>&		 permutation,
+		const vw_t					 max_allowed_size,
+			  Vector<int_t>&		 matching,
+			  Vector<ew_t>&			 matching_edge_weights
+	) {
 		for (int_t curr_V : permutation) {
 			if (matching[curr_V] != -1_i) {
 				continue;
@@ -201,28 +313,53 @@ public:
 				matching_edge_weights[curr_V] = max_W;
 			}
 		}
-
-		ProcessMatching(level, graph, new_level, matching, matching_edge_weights);
 	}
 
-	template <typename vw_t, typename ew_t>
+	template <typename vw_t, typename ew_t, typename idx_t>
 	void static HeavyCliqueMatching(
-		const CoarseLevel<vw_t, ew_t>& level,
-		const Graph<vw_t, ew_t>&	   graph,
-			  CoarseLevel<vw_t, ew_t>& new_level,
-		const int_t                    k
+		const CoarseLevel<vw_t, ew_t, idx_t>& level,
+		const Graph<vw_t, ew_t, idx_t>&	   graph,
+			  CoarseLevel<vw_t, ew_t, idx_t>& new_level,
+		const int_t                    k,
+		const PartitionerOptions&	   options
 	) {
+		if (options.coarsening_parallel_matching) {
+			ParallelMatching(level, graph, new_level, k, GetHeavyCliqueRating(level, graph), options);
+			return;
+		}
+
+		if (options.coarsening_padded_adjacency) {
+			const bool done = PaddedMatching(level, graph, new_level, k, GetHeavyCliqueRating(level, graph), options);
+			if (done) return;
+		}
 
-		Vector<int_t> permutation = GetRandomPermutation(graph.n);
+		Workspace::Buffer<int_t> permutation_buffer;
+		Vector<int_t>& permutation = permutation_buffer.get();
+		GetRandomPermutation(graph.n, permutation);
 
-		Vector<int_t> matching(graph.n, -1_i);
-		Vector<ew_t> matching_edge_weights(graph.n, c<ew_t>(0));
+		Workspace::Buffer<int_t> matching_buffer(graph.n, -1_i);
+		Workspace::Buffer<ew_t> matching_edge_weights_buffer(graph.n, c<ew_t>(0));
 
-		vw_t max_allowed_size = graph.getSumOfVertexWeights();
-		if (!ProgramConfig::coarsening_clusterization_prohibition) {
-			max_allowed_size = c<vw_t>((c<real_t>(max_allowed_size) / c<real_t>(k)) * ProgramConfig::coarsening_clusterization_size_factor);
-		}
+		Vector<int_t>& matching = matching_buffer.get();
+		Vector<ew_t>& matching_edge_weights = matching_edge_weights_buffer.get();
 
+		HeavyCliqueSweep(level, graph, permutation, GetMaxAllowedSize(graph, k, options), matching, matching_edge_weights);
+
+		TwoHopMatching(graph, k, matching, matching_edge_weights, options);
+		ProcessMatching(level, graph, new_level, matching, matching_edge_weights);
+	}
+
+	// Matching step of HeavyCliqueMatching, the same sweep as HeavyEdgeSweep
+	// with the clique density of the pair in place of the edge weight
+	template <typename vw_t, typename ew_t, typename idx_t>
+	void static HeavyCliqueSweep(
+		const CoarseLevel<vw_t, ew_t, idx_t>& level,
+		const Graph<vw_t, ew_t, idx_t>&	   graph,
+		const Vector<int_t>&			   permutation,
+		const vw_t						   max_allowed_size,
+			  Vector<int_t>&			   matching,
+			  Vector<ew_t>&				   matching_edge_weights
+	) {
 		for (int_t curr_V : permutation) {
 			if (matching[curr_V] != -1_i) {
 				continue;
@@ -235,7 +372,7 @@ public:
 			for (auto [next_V, w] : graph[curr_V]) {
 				if (graph.vertex_weights[curr_V] + graph.vertex_weights[next_V] > max_allowed_size) continue;
 				if (matching[next_V] == -1_i) {
-					ew_t total_W = level.coarsed_graph.vertex_weights[curr_V] + level.coarsed_graph.vertex_weights[next_V];
+					ew_t total_W = graph.vertex_weights[curr_V] + graph.vertex_weights[next_V];
 					ew_t F = (w + level.vertex_importance[curr_V] + level.vertex_importance[next_V]) / (total_W * (total_W - c<ew_t>(1)));
 					if (!found || F > best_F) {
 						edge_W = w;
@@ -253,25 +390,405 @@ public:
 				matching_edge_weights[curr_V] = edge_W;
 			}
 		}
+	}
+
+	// Ratings of heavy edge and heavy clique matching for the parallel and the padded sweeps
+	template <typename ew_t>
+	static auto GetHeavyEdgeRating() {
+		return [](int_t, int_t, ew_t w) {
+			return c<real_t>(w);
+		};
+	}
+
+	template <typename vw_t, typename ew_t, typename idx_t>
+	static auto GetHeavyCliqueRating(const CoarseLevel<vw_t, ew_t, idx_t>& level, const Graph<vw_t, ew_t, idx_t>& graph) {
+		return [&level, &graph](int_t curr_V, int_t next_V, ew_t w) {
+			ew_t total_W = graph.vertex_weights[curr_V] + graph.vertex_weights[next_V];
+			return c<real_t>((w + level.vertex_importance[curr_V] + level.vertex_importance[next_V]) / (total_W * (total_W - c<ew_t>(1))));
+		};
+	}
+
+	// Largest weight of a coarse vertex of a k-way partitioning
+	template <typename vw_t, typename ew_t, typename idx_t>
+	static vw_t GetMaxAllowedSize(const Graph<vw_t, ew_t, idx_t>& graph, const int_t k, const PartitionerOptions& options) {
+		vw_t max_allowed_size = graph.getSumOfVertexWeights();
+		if (!options.coarsening_clusterization_prohibition) {
+			max_allowed_size = c<vw_t>((c<real_t>(max_allowed_size) / c<real_t>(k)) * options.coarsening_clusterization_size_factor);
+		}
+		return max_allowed_size;
+	}
+
+	// Sequential matching over a PaddedAdjacency: every unmatched vertex, in
+	// random order, is matched with the first eligible neighbour of the largest
+	// `rating(curr_V, next_V, w)`, found by the MaskedArgMax kernel of
+	// `options.coarsening_instruction_set`. This is the matching of the scalar
+	// sweeps of HeavyEdgeMatching and HeavyCliqueMatching for the same ratings.
+	// Returns false, without using random numbers, if the layout can't
+	// reproduce the scalar sweep.
+	template <typename vw_t, typename ew_t, typename idx_t, typename Rating>
+	bool static PaddedMatching(
+		const CoarseLevel<vw_t, ew_t, idx_t>& level,
+		const Graph<vw_t, ew_t, idx_t>&	   graph,
+			  CoarseLevel<vw_t, ew_t, idx_t>& new_level,
+		const int_t                    k,
+		const Rating&				   rating,
+		const PartitionerOptions&	   options
+	) {
+		if constexpr (!std::is_same_v<vw_t, int_t> && !std::is_same_v<vw_t, real_t>) {
+			return false;
+		}
+		else {
+			if (graph.n > c<int_t>(std::numeric_limits<std::int32_t>::max())) {
+				return false;
+			}
+
+			PaddedAdjacency adjacency;
+			adjacency.build(graph, rating);
+			if (!adjacency.isOrdered()) {
+				return false;
+			}
+
+			Workspace::Buffer<int_t> permutation_buffer;
+			Vector<int_t>& permutation = permutation_buffer.get();
+			GetRandomPermutation(graph.n, permutation);
+
+			Workspace::Buffer<int_t> matching_buffer(graph.n, -1_i);
+			Workspace::Buffer<ew_t> matching_edge_weights_buffer(graph.n, c<ew_t>(0));
+
+			Vector<int_t>& matching = matching_buffer.get();
+			Vector<ew_t>& matching_edge_weights = matching_edge_weights_buffer.get();
+
+			PaddedSweep(graph, adjacency, options.coarsening_instruction_set, permutation, GetMaxAllowedSize(graph, k, options), matching, matching_edge_weights);
+
+			TwoHopMatching(graph, k, matching, matching_edge_weights, options);
+			ProcessMatching(level, graph, new_level, matching, matching_edge_weights);
+			return true;
+		}
+	}
+
+	// Matching step of PaddedMatching over an ordered `adjacency` of `graph`.
+	// The kernel of `set` is resolved once for the whole sweep. Matched vertices
+	// get a weight above any limit in `free_weights`, so the kernel checks both
+	// conditions with a single gather. Requires int_t or real_t vertex weights.
+	template <typename vw_t, typename ew_t, typename idx_t>
+	void static PaddedSweep(
+		const Graph<vw_t, ew_t, idx_t>& graph,
+		const PaddedAdjacency&		 adjacency,
+		ProgramConfig::InstructionSet set,
+		const Vector<int_t>&		 permutation,
+		const vw_t					 max_allowed_size,
+			  Vector<int_t>&		 matching,
+			  Vector<ew_t>&			 matching_edge_weights
+	) {
+		static_assert(std::is_same_v<vw_t, int_t> || std::is_same_v<vw_t, real_t>, "PaddedSweep requires int_t or real_t vertex weights");
+
+		const vw_t matched_weight = std::numeric_limits<vw_t>::has_infinity
+			? std::numeric_limits<vw_t>::infinity()
+			: std::numeric_limits<vw_t>::max();
+
+		Workspace::Buffer<vw_t> free_weights_buffer;
+		Vector<vw_t>& free_weights = free_weights_buffer.get();
+		free_weights.assign(graph.vertex_weights.begin(), graph.vertex_weights.end());
+
+		const auto kernel = [set]() {
+			if constexpr (std::is_same_v<vw_t, int_t>) {
+				return MaskedArgMax::GetIntegralKernel(set);
+			}
+			else {
+				return MaskedArgMax::GetFloatingKernel(set);
+			}
+		}();
+
+		for (int_t curr_V : permutation) {
+			if (matching[curr_V] != -1_i) {
+				continue;
+			}
+
+			int_t position;
+			if constexpr (std::is_same_v<vw_t, int_t>) {
+				position = adjacency.find(kernel, curr_V, free_weights.data(), max_allowed_size - graph.vertex_weights[curr_V]);
+			}
+			else {
+				position = adjacency.find(kernel, curr_V, free_weights.data(), graph.vertex_weights[curr_V], max_allowed_size);
+			}
+
+			if (position == -1_i) {
+				continue;
+			}
+
+			const int_t best_V = graph.adjncy[graph.xadj[curr_V] + position];
+			const ew_t edge_W = graph.edge_weights[graph.xadj[curr_V] + position];
+
+			matching[best_V] = curr_V;
+			matching[curr_V] = best_V;
+			matching_edge_weights[best_V] = edge_W;
+			matching_edge_weights[curr_V] = edge_W;
+			free_weights[best_V] = matched_weight;
+			free_weights[curr_V] = matched_weight;
+		}
+	}
+
+	// Multi-threaded matching built from handshakes.
+	//
+	// Every round each unmatched vertex proposes to its best eligible unmatched
+	// neighbour according to `rating(curr_V, next_V, w)` (higher is better), and
+	// two vertices that propose to each other are matched. Ties are broken by
+	// a hash of the edge, so proposals and therefore the result do not depend
+	// on the number of threads. Since the rating is symmetric, the best edge
+	// among active vertices is always mutual, so each round makes progress.
+	template <typename vw_t, typename ew_t, typename idx_t, typename Rating>
+	void static ParallelMatching(
+		const CoarseLevel<vw_t, ew_t, idx_t>& level,
+		const Graph<vw_t, ew_t, idx_t>&	   graph,
+			  CoarseLevel<vw_t, ew_t, idx_t>& new_level,
+		const int_t                    k,
+		const Rating&				   rating,
+		const PartitionerOptions&	   options
+	) {
+		std::shared_ptr<ThreadPool> pool = ThreadPool::GetInstance(options.threads_count);
+
+		const std::uint64_t tie_seed = GetRandomSeed();
+		const int_t grain_size = 1024_i;
+
+		Workspace::Buffer<int_t> matching_buffer(graph.n, -1_i);
+		Workspace::Buffer<ew_t> matching_edge_weights_buffer(graph.n, c<ew_t>(0));
+
+		Vector<int_t>& matching = matching_buffer.get();
+		Vector<ew_t>& matching_edge_weights = matching_edge_weights_buffer.get();
+
+		vw_t max_allowed_size = graph.getSumOfVertexWeights();
+		if (!options.coarsening_clusterization_prohibition) {
+			max_allowed_size = c<vw_t>((c<real_t>(max_allowed_size) / c<real_t>(k)) * options.coarsening_clusterization_size_factor);
+		}
+
+		Workspace::Buffer<int_t> candidate_buffer(graph.n, -1_i);
+		Workspace::Buffer<ew_t> candidate_edge_weights_buffer(graph.n, c<ew_t>(0));
+		Workspace::Buffer<int_t> active_buffer(graph.n, 0_i);
+
+		Vector<int_t>& candidate = candidate_buffer.get();
+		Vector<ew_t>& candidate_edge_weights = candidate_edge_weights_buffer.get();
+		Vector<int_t>& active = active_buffer.get();
+		std::iota(active.begin(), active.end(), 0_i);
+
+		for (int_t round = 0_i; round < options.coarsening_parallel_matching_rounds_limit && !active.empty(); ++round) {
+
+			// 1. Proposals (reads `matching` only)
+			pool->ParallelFor(0_i, active.size(), grain_size, [&](int_t i) {
+				const int_t curr_V = active[i];
+
+				int_t best_V = -1_i;
+				real_t best_R = 0.0_r;
+				std::uint64_t best_T = 0ull;
+				ew_t edge_W = c<ew_t>(0);
+
+				for (int_t j = graph.xadj[curr_V]; j < graph.xadj[curr_V + 1_i]; ++j) {
+					const int_t next_V = graph.adjncy[j];
+					const ew_t w = graph.edge_weights[j];
+
+					if (next_V == curr_V || matching[next_V] != -1_i) continue;
+					if (graph.vertex_weights[curr_V] + graph.vertex_weights[next_V] > max_allowed_size) continue;
+
+					const real_t R = rating(curr_V, next_V, w);
+					const std::uint64_t T = MixBits(tie_seed ^ MixBits(
+						(static_cast<std::uint64_t>(std::min(curr_V, next_V)) << 32) ^ static_cast<std::uint64_t>(std::max(curr_V, next_V))
+					));
+
+					if (best_V == -1_i || R > best_R || (R == best_R && T > best_T)) {
+						best_V = next_V;
+						best_R = R;
+						best_T = T;
+						edge_W = w;
+					}
+				}
+
+				candidate[curr_V] = best_V;
+				candidate_edge_weights[curr_V] = edge_W;
+			});
+
+			// 2. Handshakes (each pair is written by its smaller vertex only)
+			pool->ParallelFor(0_i, active.size(), grain_size, [&](int_t i) {
+				const int_t curr_V = active[i];
+				const int_t next_V = candidate[curr_V];
+
+				if (next_V != -1_i && curr_V < next_V && candidate[next_V] == curr_V) {
+					matching[curr_V] = next_V;
+					matching[next_V] = curr_V;
+					matching_edge_weights[curr_V] = candidate_edge_weights[curr_V];
+					matching_edge_weights[next_V] = candidate_edge_weights[curr_V];
+				}
+			});
+
+			// 3. Vertices without a candidate can not be matched in later rounds either
+			int_t active_count = 0_i;
+			for (int_t curr_V : active) {
+				if (matching[curr_V] == -1_i && candidate[curr_V] != -1_i) {
+					active[active_count++] = curr_V;
+				}
+			}
+			if (active_count == static_cast<int_t>(active.size())) {
+				break;
+			}
+			active.resize(active_count);
+		}
 
+		// The two-hop passes are sequential, so they are not run here
 		ProcessMatching(level, graph, new_level, matching, matching_edge_weights);
 	}
 
+	// Two-hop matching: pairs vertices left unmatched by the matching of a level
+	// through a common neighbour. Around star-like hubs most vertices have no
+	// unmatched neighbour, so without these pairs such a level barely shrinks.
+	//
+	// Runs only if more than `options.coarsening_two_hop_unmatched_fraction` of
+	// the vertices are unmatched, and tries, while that is still the case:
+	//   1. leaves (vertices of degree 1) hanging off the same vertex,
+	//   2. twins, vertices with the same set of neighbours,
+	//   3. any two vertices with a common neighbour.
+	// Only vertices of degree below `options.coarsening_two_hop_degree_limit` are
+	// paired in 2 and 3, so every pass is O(n + m). The passes are sequential and
+	// use no random numbers, so the result doesn't depend on the number of threads.
+	// They follow the sequential matchings only: with
+	// `options.coarsening_parallel_matching` they would serialise every level.
+	template <typename vw_t, typename ew_t, typename idx_t>
+	void static TwoHopMatching(
+		const Graph<vw_t, ew_t, idx_t>& graph,
+		const int_t              k,
+			  Vector<int_t>&     matching,
+			  Vector<ew_t>&      matching_edge_weights,
+		const PartitionerOptions& options
+	) {
+		if (!options.coarsening_two_hop_matching) {
+			return;
+		}
+
+		const int_t unmatched_limit = c<int_t>(options.coarsening_two_hop_unmatched_fraction * c<real_t>(graph.n));
+
+		int_t unmatched_count = std::count(matching.begin(), matching.end(), -1_i);
+		if (unmatched_count <= unmatched_limit) {
+			return;
+		}
+		const int_t initial_unmatched_count = unmatched_count;
+
+		vw_t max_allowed_size = graph.getSumOfVertexWeights();
+		if (!options.coarsening_clusterization_prohibition) {
+			max_allowed_size = c<vw_t>((c<real_t>(max_allowed_size) / c<real_t>(k)) * options.coarsening_clusterization_size_factor);
+		}
+
+		auto can_match = [&](int_t u, int_t v) {
+			return u != v && matching[u] == -1_i && matching[v] == -1_i &&
+				graph.vertex_weights[u] + graph.vertex_weights[v] <= max_allowed_size;
+		};
+
+		auto match = [&](int_t u, int_t v) {
+			// Pairs are usually not adjacent, but e.g. two leaves of an edge are
+			const int_t scanned_V = (graph.getDegree(u) <= graph.getDegree(v)) ? u : v;
+			const int_t other_V = (scanned_V == u) ? v : u;
+
+			ew_t edge_W = c<ew_t>(0);
+			for (auto [next_V, w] : graph[scanned_V]) {
+				if (next_V == other_V) edge_W += w;
+			}
+
+			matching[u] = v;
+			matching[v] = u;
+			matching_edge_weights[u] = edge_W;
+			matching_edge_weights[v] = edge_W;
+			unmatched_count -= 2_i;
+		};
+
+		// 1 and 3: unmatched neighbours of every vertex are paired in the order of its row
+		auto match_common_neighbours = [&](int_t degree_limit) {
+			for (int_t hub_V = 0_i; hub_V < graph.n; ++hub_V) {
+				int_t pending_V = -1_i;
+				for (auto [next_V, w] : graph[hub_V]) {
+					if (matching[next_V] != -1_i || graph.getDegree(next_V) >= degree_limit || next_V == pending_V) continue;
+
+					if (pending_V == -1_i) {
+						pending_V = next_V;
+					}
+					else if (can_match(pending_V, next_V)) {
+						match(pending_V, next_V);
+						pending_V = -1_i;
+					}
+					else if (graph.vertex_weights[next_V] < graph.vertex_weights[pending_V]) {
+						pending_V = next_V;
+					}
+				}
+			}
+		};
+
+		// 2: candidates are sorted by a hash of their neighbourhood, which is then compared exactly
+		auto match_twins = [&](int_t degree_limit) {
+			Workspace::Buffer<std::pair<std::uint64_t, int_t>> candidates_buffer;
+			Vector<std::pair<std::uint64_t, int_t>>& candidates = candidates_buffer.get();
+			candidates.clear();
+
+			for (int_t curr_V = 0_i; curr_V < graph.n; ++curr_V) {
+				const int_t degree = graph.getDegree(curr_V);
+				if (matching[curr_V] != -1_i || degree < 2_i || degree >= degree_limit) continue;
+
+				std::uint64_t hash = MixBits(static_cast<std::uint64_t>(degree));
+				for (auto [next_V, w] : graph[curr_V]) {
+					hash += MixBits(static_cast<std::uint64_t>(next_V));
+				}
+				candidates.emplace_back(hash, curr_V);
+			}
+			std::sort(candidates.begin(), candidates.end());
+
+			Workspace::Buffer<int_t> marker_buffer(graph.n, -1_i);
+			Vector<int_t>& marker = marker_buffer.get();
+
+			auto same_neighbours = [&](int_t u, int_t v) {
+				for (auto [next_V, w] : graph[u]) {
+					marker[next_V] = u;
+				}
+				for (auto [next_V, w] : graph[v]) {
+					if (marker[next_V] != u) return false;
+				}
+				return true;
+			};
+
+			for (size_t i = 0; i + 1 < candidates.size(); ++i) {
+				const int_t u = candidates[i].second;
+				const int_t v = candidates[i + 1].second;
+				if (candidates[i].first == candidates[i + 1].first && graph.getDegree(u) == graph.getDegree(v) &&
+					can_match(u, v) && same_neighbours(u, v)) {
+					match(u, v);
+					++i;
+				}
+			}
+		};
+
+		match_common_neighbours(2_i);
+		if (unmatched_count > unmatched_limit) {
+			match_twins(options.coarsening_two_hop_degree_limit);
+		}
+		if (unmatched_count > unmatched_limit) {
+			match_common_neighbours(options.coarsening_two_hop_degree_limit);
+		}
+
+		Instrumentation::Count("two_hop_matched", c<real_t>(initial_unmatched_count - unmatched_count));
+	}
+
 	// This function builds the coarse level based on the found matching
-	template <typename vw_t, typename ew_t>
+	template <typename vw_t, typename ew_t, typename idx_t>
 	void static ProcessMatching(
-		const CoarseLevel<vw_t, ew_t>& level,
-		const Graph<vw_t, ew_t>&       graph,
-			  CoarseLevel<vw_t, ew_t>& new_level,
+		const CoarseLevel<vw_t, ew_t, idx_t>& level,
+		const Graph<vw_t, ew_t, idx_t>&       graph,
+			  CoarseLevel<vw_t, ew_t, idx_t>& new_level,
 		const Vector<int_t>&		   matching,
 		const Vector<ew_t>&			   matching_edge_weights
 	) {
 		// 1. Filling coarse vectors
 
-		Vector<int_t> uncoarse_to_coarse(graph.n, -1_i);
+		Vector<idx_t> uncoarse_to_coarse(graph.n, -1);
 
-		Vector<Vector<int_t>> coarse_to_uncoarse;
-		coarse_to_uncoarse.reserve(graph.n / 2_i + 1_i);
+		Vector<int_t> coarse_to_uncoarse_xadj;
+		coarse_to_uncoarse_xadj.reserve(graph.n + 1_i);
+		coarse_to_uncoarse_xadj.push_back(0_i);
+
+		Vector<idx_t> coarse_to_uncoarse;
+		coarse_to_uncoarse.reserve(graph.n);
 
 		int_t vertex_count = 0_i;
 
@@ -279,90 +796,174 @@ public:
 			if (uncoarse_to_coarse[curr_V] != -1_i) continue;
 
 			int_t next_V = matching[curr_V];
-			Vector<int_t> component;
 
 			if (next_V == -1_i) {
 				uncoarse_to_coarse[curr_V] = vertex_count;
-				component.push_back(curr_V);
+				coarse_to_uncoarse.push_back(curr_V);
 			}
 			else if (curr_V < next_V) {
 				uncoarse_to_coarse[curr_V] = vertex_count;
 				uncoarse_to_coarse[next_V] = vertex_count;
-				component.push_back(curr_V);
-				component.push_back(next_V);
+				coarse_to_uncoarse.push_back(curr_V);
+				coarse_to_uncoarse.push_back(next_V);
 			}
 
-			coarse_to_uncoarse.push_back(std::move(component));
+			coarse_to_uncoarse_xadj.push_back(coarse_to_uncoarse.size());
 			++vertex_count;
 		}
 
 		// 2. Building graph
 
-		Graph<vw_t, ew_t> coarsed_graph;
-		coarsed_graph.n = coarse_to_uncoarse.size();
+		Graph<vw_t, ew_t, idx_t> coarsed_graph;
+		coarsed_graph.n = vertex_count;
 		coarsed_graph.vertex_weights.resize(coarsed_graph.n, c<vw_t>(0));
 
 		for (int_t curr_V = 0_i; curr_V < coarsed_graph.n; ++curr_V) {
-			for (int_t next_V : coarse_to_uncoarse[curr_V]) {
-				coarsed_graph.vertex_weights[curr_V] += graph.vertex_weights[next_V];
+			for (int_t i = coarse_to_uncoarse_xadj[curr_V]; i < coarse_to_uncoarse_xadj[curr_V + 1_i]; ++i) {
+				coarsed_graph.vertex_weights[curr_V] += graph.vertex_weights[coarse_to_uncoarse[i]];
 			}
 		}
 
 		// 3. Edges
-		Vector<std::unordered_map<int_t, ew_t>> tmp_edges(coarsed_graph.n);
+		//
+		// The coarse adjacency is built in two passes straight into CSR:
+		// the first one counts distinct coarse neighbours of every coarse vertex,
+		// the second one fills `adjncy` and accumulates parallel edge weights.
+		// `edge_position[c_next_V]` holds the slot of the edge (c_curr_V, c_next_V)
+		// in `adjncy`; since rows are filled in order, a slot that is not inside
+		// the current row means that the edge has not been seen yet.
 
-		for (int_t c_curr_V = 0_i; c_curr_V < coarsed_graph.n; ++c_curr_V) {
-			for (int_t u_curr_V : coarse_to_uncoarse[c_curr_V]) {
-				for (auto [u_next_V, w] : graph[u_curr_V]) {
-					int_t c_next_V = uncoarse_to_coarse[u_next_V];
+		Workspace::Buffer<int_t> edge_position_buffer(coarsed_graph.n, -1_i);
+		Vector<int_t>& edge_position = edge_position_buffer.get();
 
-					if (c_next_V != c_curr_V) {
-						tmp_edges[c_curr_V][c_next_V] += w;
+		coarsed_graph.xadj.resize(coarsed_graph.n + 1_i);
+		coarsed_graph.xadj[0_i] = 0_i;
+
+		for (int_t c_curr_V = 0_i; c_curr_V < coarsed_graph.n; ++c_curr_V) {
+			int_t degree = 0_i;
+			for (int_t j = coarse_to_uncoarse_xadj[c_curr_V]; j < coarse_to_uncoarse_xadj[c_curr_V + 1_i]; ++j) {
+				int_t u_curr_V = coarse_to_uncoarse[j];
+				for (int_t i = graph.xadj[u_curr_V]; i < graph.xadj[u_curr_V + 1_i]; ++i) {
+					int_t c_next_V = uncoarse_to_coarse[graph.adjncy[i]];
+
+					if (c_next_V != c_curr_V && edge_position[c_next_V] != c_curr_V) {
+						edge_position[c_next_V] = c_curr_V;
+						++degree;
 					}
 				}
 			}
+			coarsed_graph.xadj[c_curr_V + 1_i] = coarsed_graph.xadj[c_curr_V] + degree;
 		}
 
-		int_t total_edges = 0_i;
-		Vector<int_t> edge_count(coarsed_graph.n, 0_i);
-		for (int_t i = 0_i; i < coarsed_graph.n; ++i) {
-			edge_count[i] = tmp_edges[i].size();
-			total_edges += edge_count[i];
-		}
+		coarsed_graph.m = coarsed_graph.xadj[coarsed_graph.n];
+		coarsed_graph.adjncy.resize(coarsed_graph.m);
+		coarsed_graph.edge_weights.resize(coarsed_graph.m);
 
-		coarsed_graph.m = total_edges;
-		coarsed_graph.xadj.resize(coarsed_graph.n + 1_i);
-		coarsed_graph.adjncy.resize(total_edges);
-		coarsed_graph.edge_weights.resize(total_edges);
+		std::fill(edge_position.begin(), edge_position.end(), -1_i);
 
-		int_t pos = 0_i;
-		for (int_t curr_V = 0_i; curr_V < coarsed_graph.n; ++curr_V) {
-			coarsed_graph.xadj[curr_V] = pos;
-			for (auto& [next_V, weight] : tmp_edges[curr_V]) {
-				coarsed_graph.adjncy[pos] = next_V;
-				coarsed_graph.edge_weights[pos] = weight;
-				pos++;
+		for (int_t c_curr_V = 0_i; c_curr_V < coarsed_graph.n; ++c_curr_V) {
+			const int_t row_begin = coarsed_graph.xadj[c_curr_V];
+			int_t pos = row_begin;
+
+			for (int_t j = coarse_to_uncoarse_xadj[c_curr_V]; j < coarse_to_uncoarse_xadj[c_curr_V + 1_i]; ++j) {
+				int_t u_curr_V = coarse_to_uncoarse[j];
+				for (int_t i = graph.xadj[u_curr_V]; i < graph.xadj[u_curr_V + 1_i]; ++i) {
+					int_t c_next_V = uncoarse_to_coarse[graph.adjncy[i]];
+
+					if (c_next_V == c_curr_V) continue;
+
+					if (edge_position[c_next_V] >= row_begin) {
+						coarsed_graph.edge_weights[edge_position[c_next_V]] += graph.edge_weights[i];
+					}
+					else {
+						edge_position[c_next_V] = pos;
+						coarsed_graph.adjncy[pos] = c_next_V;
+						coarsed_graph.edge_weights[pos] = graph.edge_weights[i];
+						++pos;
+					}
+				}
 			}
 		}
-		coarsed_graph.xadj[coarsed_graph.n] = pos;
 
 		// 4. Importance
 
 		Vector<ew_t> vertex_importance(coarsed_graph.n, c<ew_t>(0));
 		for (int_t curr_V = 0_i; curr_V < coarsed_graph.n; ++curr_V) {
-			for (int_t prev_V: coarse_to_uncoarse[curr_V]) {
-				vertex_importance[curr_V] += level.vertex_importance[prev_V];
+			const int_t first = coarse_to_uncoarse_xadj[curr_V];
+			const int_t last = coarse_to_uncoarse_xadj[curr_V + 1_i];
+
+			for (int_t i = first; i < last; ++i) {
+				vertex_importance[curr_V] += level.vertex_importance[coarse_to_uncoarse[i]];
 			}
-			if (coarse_to_uncoarse[curr_V].size() == 2_i) {
-				vertex_importance[curr_V] += matching_edge_weights[coarse_to_uncoarse[curr_V][0_i]];
+			if (last - first == 2_i) {
+				vertex_importance[curr_V] += matching_edge_weights[coarse_to_uncoarse[first]];
 			}
 		}
 
 		// 5. Results
 
 		new_level.uncoarse_to_coarse = std::move(uncoarse_to_coarse);
+		new_level.coarse_to_uncoarse_xadj = std::move(coarse_to_uncoarse_xadj);
 		new_level.coarse_to_uncoarse = std::move(coarse_to_uncoarse);
 		new_level.coarsed_graph = std::move(coarsed_graph);
 		new_level.vertex_importance = std::move(vertex_importance);
 	}
-};
\ No newline at end of file
+};
+
+// A matching strategy builds the next coarse level with
+// FillLevel(level, graph, new_level, k, options)
+template <>
+struct MatchingStrategy<ProgramConfig::CoarseningMethod::RandomMatching> {
+	template <typename vw_t, typename ew_t, typename idx_t>
+	static void FillLevel(
+		const CoarseLevel<vw_t, ew_t, idx_t>& level,
+		const Graph<vw_t, ew_t, idx_t>&	   graph,
+			  CoarseLevel<vw_t, ew_t, idx_t>& new_level,
+		const int_t                    k,
+		const PartitionerOptions&	   options
+	) {
+		Coarser::RandomMatching(level, graph, new_level, k, options);
+	}
+};
+
+template <>
+struct MatchingStrategy<ProgramConfig::CoarseningMethod::LightEdgeMatching> {
+	template <typename vw_t, typename ew_t, typename idx_t>
+	static void FillLevel(
+		const CoarseLevel<vw_t, ew_t, idx_t>& level,
+		const Graph<vw_t, ew_t, idx_t>&	   graph,
+			  CoarseLevel<vw_t, ew_t, idx_t>& new_level,
+		const int_t                    k,
+		const PartitionerOptions&	   options
+	) {
+		Coarser::LightEdgeMatching(level, graph, new_level, k, options);
+	}
+};
+
+template <>
+struct MatchingStrategy<ProgramConfig::CoarseningMethod::HeavyEdgeMatching> {
+	template <typename vw_t, typename ew_t, typename idx_t>
+	static void FillLevel(
+		const CoarseLevel<vw_t, ew_t, idx_t>& level,
+		const Graph<vw_t, ew_t, idx_t>&	   graph,
+			  CoarseLevel<vw_t, ew_t, idx_t>& new_level,
+		const int_t                    k,
+		const PartitionerOptions&	   options
+	) {
+		Coarser::HeavyEdgeMatching(level, graph, new_level, k, options);
+	}
+};
+
+template <>
+struct MatchingStrategy<ProgramConfig::CoarseningMethod::HeavyCliqueMatching> {
+	template <typename vw_t, typename ew_t, typename idx_t>
+	static void FillLevel(
+		const CoarseLevel<vw_t, ew_t, idx_t>& level,
+		const Graph<vw_t, ew_t, idx_t>&	   graph,
+			  CoarseLevel<vw_t, ew_t, idx_t>& new_level,
+		const int_t                    k,
+		const PartitionerOptions&	   options
+	) {
+		Coarser::HeavyCliqueMatching(level, graph, new_level, k, options);
+	}
+};
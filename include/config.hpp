@@ -1,8 +1,15 @@
 #pragma once
 
 #include "utils.hpp"
+#include "instrumentation.hpp"
 
 namespace ProgramConfig {
+    // --- Partitioning methods ---
+    enum class PartitioningMethod {
+        RecursiveBisection,
+        DirectKWay,
+    };
+
     // --- Coarsening methods ---
     enum class CoarseningMethod {
         RandomMatching,
@@ -20,38 +27,175 @@ namespace ProgramConfig {
     // --- Uncoarsening methods ---
     enum class UncoarseningMethod {
         DirectMapping,
-        KernighanLin
+        KernighanLin,
+        FiducciaMattheyses
+    };
+
+    // --- Instruction sets of the vector kernels ---
+    enum class InstructionSet {
+        Scalar,
+        AVX2,
+        AVX512,
+        Best,     // the widest set supported by the processor
     };
 
     // --- Global parameters ---
     inline real_t accuracy = 0.05_r;
 
+    // --- Partitioning parameters ---
+    inline PartitioningMethod partitioning_method = PartitioningMethod::RecursiveBisection;
+
+    // DirectKWay coarsens the graph once, down to about k * this number of vertices
+    inline int_t partitioning_DirectKWay_vertices_per_part = 20_i;
+
+    // --- Parallelism parameters ---
+
+    // Number of threads (including the calling one) used by the partitioner.
+    // With the same random seed the result does not depend on this value.
+    inline int_t threads_count = 1_i;
+
+    // --- Random parameters ---
+
+    // Seed of the random streams of GetGraphKPartition: the same seed gives
+    // the same partition for any number of threads.
+    // A negative value keeps the stream of the calling thread (see SetRandomSeed).
+    inline int_t random_seed = 0_i;
+
     // --- Coarsening parameters ---
     inline CoarseningMethod coarsening_method = CoarseningMethod::HeavyEdgeMatching;
 
     inline int_t coarsening_itarations_limit = 40_i;
     inline int_t coarsening_vertix_count_limit = 100_i;
 
+    // Use the multi-threaded handshake matching instead of the sequential sweep.
+    // The matching is the same for any number of threads.
+    inline bool coarsening_parallel_matching = false;
+    inline int_t coarsening_parallel_matching_rounds_limit = 8_i;
+
     inline bool coarsening_clusterization_prohibition = false;
 	inline real_t coarsening_clusterization_size_factor = 0.5_r;
 
+    // Sequential heavy edge and heavy clique matching scan a padded copy of the
+    // adjacency with vector kernels (see padded_adjacency.hpp). The matching is
+    // the same as without it.
+    inline bool coarsening_padded_adjacency = false;
+    // A set that the processor does not support falls back to the best supported one
+    inline InstructionSet coarsening_instruction_set = InstructionSet::Best;
+
+    // Vertices left unmatched by the matching of a level are paired through a
+    // common neighbour (leaves, twins, then any two-hop pairs) when more than
+    // this fraction of the vertices is unmatched. Not used by the parallel matching.
+    inline bool coarsening_two_hop_matching = true;
+    inline real_t coarsening_two_hop_unmatched_fraction = 0.10_r;
+    // Twins and general two-hop pairs are searched among vertices of a lower degree
+    inline int_t coarsening_two_hop_degree_limit = 64_i;
+
+    // Coarsening stops once a level keeps more than this fraction of the vertices
+    inline real_t coarsening_stall_contraction_ratio = 0.95_r;
+
     // --- Bipartitioning parameters ---
     inline BipartitioningMethod bipartitioning_method = BipartitioningMethod::GraphGrowingAlgorithm;
 
     inline int_t bipartitioning_GraphGrowingAlgorithm_launches_count = 100_i;
     inline int_t bipartitioning_GreedyGraphGrowingAlgorithm_launches_count = 100_i;
 
+    // Stop launching after this many consecutive launches without improvement (0 - never stop)
+    inline int_t bipartitioning_launches_without_improvement_limit = 0_i;
+
     // --- Uncoarsening parameters ---
 	inline UncoarseningMethod uncoarsening_method = UncoarseningMethod::DirectMapping;   
 
 	inline bool uncoarsening_KernighanLin_use_blocking = true;
 
+	inline int_t uncoarsening_KWay_passes_count = 8_i;
+
+	inline int_t uncoarsening_FiducciaMattheyses_passes_count = 8_i;
+	// A pass is stopped after this many moves that do not improve the best cut found in it
+	inline int_t uncoarsening_FiducciaMattheyses_moves_without_improvement_limit = 100_i;
+
 	// --- Post processing parameters ---
 
     // Correctness is guaranteed only for graphs with vertex weights equal to 1
 	inline bool post_processing_disbalance_fix = true;
 	inline bool post_processing_improvement = true;
+	inline int_t post_processing_improvement_rounds_limit = 16_i;
 
 	// --- Statistics parameters ---
 	inline bool collect_mathing_statistics = false;
+
+	// Build a report of phase times and counters for every GetGraphKPartition call
+	// (see Instrumentation, requires the YAGKP_INSTRUMENTATION build option)
+	inline bool collect_instrumentation = false;
 }
+
+// Settings of one partitioning job.
+//
+// Every phase of the pipeline reads its parameters from the options it is
+// given, so jobs with different settings can run concurrently in one process.
+// A default-constructed object takes the current values of the ProgramConfig
+// globals, which therefore act as the defaults.
+// The matching statistics (ProgramStatistics) stay process-wide.
+struct PartitionerOptions {
+    real_t accuracy = ProgramConfig::accuracy;
+
+    // --- Partitioning parameters ---
+    ProgramConfig::PartitioningMethod partitioning_method = ProgramConfig::partitioning_method;
+    int_t partitioning_DirectKWay_vertices_per_part = ProgramConfig::partitioning_DirectKWay_vertices_per_part;
+
+    // --- Parallelism parameters ---
+    int_t threads_count = ProgramConfig::threads_count;
+
+    // --- Random parameters ---
+    int_t random_seed = ProgramConfig::random_seed;
+
+    // --- Coarsening parameters ---
+    ProgramConfig::CoarseningMethod coarsening_method = ProgramConfig::coarsening_method;
+
+    int_t coarsening_itarations_limit = ProgramConfig::coarsening_itarations_limit;
+    int_t coarsening_vertix_count_limit = ProgramConfig::coarsening_vertix_count_limit;
+
+    bool coarsening_parallel_matching = ProgramConfig::coarsening_parallel_matching;
+    int_t coarsening_parallel_matching_rounds_limit = ProgramConfig::coarsening_parallel_matching_rounds_limit;
+
+    bool coarsening_clusterization_prohibition = ProgramConfig::coarsening_clusterization_prohibition;
+    real_t coarsening_clusterization_size_factor = ProgramConfig::coarsening_clusterization_size_factor;
+
+    bool coarsening_padded_adjacency = ProgramConfig::coarsening_padded_adjacency;
+    ProgramConfig::InstructionSet coarsening_instruction_set = ProgramConfig::coarsening_instruction_set;
+
+    bool coarsening_two_hop_matching = ProgramConfig::coarsening_two_hop_matching;
+    real_t coarsening_two_hop_unmatched_fraction = ProgramConfig::coarsening_two_hop_unmatched_fraction;
+    int_t coarsening_two_hop_degree_limit = ProgramConfig::coarsening_two_hop_degree_limit;
+
+    real_t coarsening_stall_contraction_ratio = ProgramConfig::coarsening_stall_contraction_ratio;
+
+    // --- Bipartitioning parameters ---
+    ProgramConfig::BipartitioningMethod bipartitioning_method = ProgramConfig::bipartitioning_method;
+
+    int_t bipartitioning_GraphGrowingAlgorithm_launches_count = ProgramConfig::bipartitioning_GraphGrowingAlgorithm_launches_count;
+    int_t bipartitioning_GreedyGraphGrowingAlgorithm_launches_count = ProgramConfig::bipartitioning_GreedyGraphGrowingAlgorithm_launches_count;
+    int_t bipartitioning_launches_without_improvement_limit = ProgramConfig::bipartitioning_launches_without_improvement_limit;
+
+    // --- Uncoarsening parameters ---
+    ProgramConfig::UncoarseningMethod uncoarsening_method = ProgramConfig::uncoarsening_method;
+
+    bool uncoarsening_KernighanLin_use_blocking = ProgramConfig::uncoarsening_KernighanLin_use_blocking;
+
+    int_t uncoarsening_KWay_passes_count = ProgramConfig::uncoarsening_KWay_passes_count;
+
+    int_t uncoarsening_FiducciaMattheyses_passes_count = ProgramConfig::uncoarsening_FiducciaMattheyses_passes_count;
+    int_t uncoarsening_FiducciaMattheyses_moves_without_improvement_limit = ProgramConfig::uncoarsening_FiducciaMattheyses_moves_without_improvement_limit;
+
+    // --- Post processing parameters ---
+    bool post_processing_disbalance_fix = ProgramConfig::post_processing_disbalance_fix;
+    bool post_processing_improvement = ProgramConfig::post_processing_improvement;
+    int_t post_processing_improvement_rounds_limit = ProgramConfig::post_processing_improvement_rounds_limit;
+
+    // --- Statistics parameters ---
+    bool collect_instrumentation = ProgramConfig::collect_instrumentation;
+
+    // If not null, receives the report of the GetGraphKPartition call when
+    // collect_instrumentation is set (unlike Instrumentation::GetLastReport,
+    // it is not shared with concurrent calls)
+    Instrumentation::Report* instrumentation_report = nullptr;
+};
@@ -2,9 +2,19 @@
 
 #include "matrix.hpp"
 #include "utils.hpp"
-
+#include "binary_graph.hpp"
+#include "mtx_reader.hpp"
+#include "config.hpp"
+#include "instrumentation.hpp"
+#include "workspace.hpp"
+
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <stdexcept>
 #include <map>
 #include <unordered_map>
+#include <utility>
 
 class Partitioner;
 class Coarser;
@@ -14,7 +24,7 @@ class PartitionMetrics;
 
 class CoarseTest;
 
-template <typename vw_t, typename ew_t> class GraphTester;
+template <typename vw_t, typename ew_t, typename idx_t = vid_t> class GraphTester;
 
 // Graph stored in Compressed Row Storage (CRS/CSR) format.
 // Vertices are numbered starting from 0.
@@ -22,18 +32,22 @@ template <typename vw_t, typename ew_t> class GraphTester;
 // Template parameters:
 //   vw_t  type of vertex weights
 //   ew_t - type of edge weights
+//   idx_t - type of vertex ids in the adjacency list (32-bit by default,
+//           the edge offsets in xadj are always int_t)
 //
-template <typename vw_t, typename ew_t>
+template <typename vw_t, typename ew_t, typename idx_t = vid_t>
 class Graph {
 
 	friend class Partitioner;
+	template <typename Matching, typename InitialPartitioner, typename Refiner>
+	friend class BasicPartitioner;
 	friend class Coarser;
 	friend class Bipartitioner;
 
 	friend class PartitionMetrics;
 
 	friend class CoarseTest;
-	friend class GraphTester<vw_t, ew_t>;
+	friend class GraphTester<vw_t, ew_t, idx_t>;
 
 private:
 	int_t n = 0_i; // Number of vertices
@@ -41,7 +55,7 @@ private:
 
 	// Adjacency list:
 	//   adjncy[xadj[u] .. xadj[u+1]-1] contains neighbors of vertex u.
-	Vector<int_t> adjncy;
+	Vector<idx_t> adjncy;
 
 	// Row pointer array:
 	//   xadj[u] = index in `adjncy` where adjacency of vertex u begins.
@@ -93,13 +107,133 @@ public:
 	}
 
 private:
+	template <typename T>
+	static void readBinarySection(const std::byte*& cursor, Vector<T>& section, int_t count) {
+		section.resize(count);
+		if (count > 0_i) {
+			std::memcpy(section.data(), cursor, c<std::size_t>(count) * sizeof(T));
+		}
+		cursor += GetBinarySectionSize(c<std::uint64_t>(count) * sizeof(T));
+	}
+
+	template <typename T>
+	static void writeBinarySection(std::ofstream& file, const Vector<T>& section) {
+		static const char padding[8] = {};
+
+		const std::uint64_t bytes = section.size() * sizeof(T);
+		file.write(reinterpret_cast<const char*>(section.data()), bytes);
+		file.write(padding, GetBinarySectionSize(bytes) - bytes);
+	}
+
+	// Reads vertex ids stored with another integer type
+	template <typename stored_t>
+	static void readBinaryIds(const std::byte*& cursor, Vector<idx_t>& section, int_t count) {
+		section.resize(count);
+		for (int_t i = 0_i; i < count; ++i) {
+			stored_t id;
+			std::memcpy(&id, cursor + i * sizeof(stored_t), sizeof(stored_t));
+			section[i] = static_cast<idx_t>(id);
+		}
+		cursor += GetBinarySectionSize(c<std::uint64_t>(count) * sizeof(stored_t));
+	}
+
+	static std::uint64_t getBinaryPayloadSize(int_t n, int_t m, std::uint64_t id_size) {
+		return GetBinarySectionSize(c<std::uint64_t>(n + 1_i) * sizeof(int_t))
+			 + GetBinarySectionSize(c<std::uint64_t>(m) * id_size)
+			 + GetBinarySectionSize(c<std::uint64_t>(n) * sizeof(vw_t))
+			 + GetBinarySectionSize(c<std::uint64_t>(m) * sizeof(ew_t));
+	}
+
+	// The file is mapped and validated, then every section is copied with a single memcpy.
+	// Vertex ids written with another id type are converted.
+	void loadBinary(const String& file_name, bool ignore_eweights) {
+		static_assert(sizeof(int_t) == sizeof(std::int64_t), "The binary format stores 64-bit offsets");
+
+		MappedFile file(file_name);
+
+		BinaryGraphHeader header;
+		if (file.size() < sizeof(header)) {
+			throw std::runtime_error("Binary graph file is too small: " + file_name);
+		}
+		std::memcpy(&header, file.data(), sizeof(header));
+
+		if (std::memcmp(header.magic, BINARY_GRAPH_MAGIC, sizeof(header.magic)) != 0) {
+			throw std::runtime_error("Not a binary graph file: " + file_name);
+		}
+		if (header.version != BINARY_GRAPH_VERSION || header.header_size != sizeof(header)) {
+			throw std::runtime_error("Unsupported binary graph version: " + file_name);
+		}
+		if (header.vertex_weight_type != GetBinaryTypeTag<vw_t>() || header.edge_weight_type != GetBinaryTypeTag<ew_t>()) {
+			throw std::runtime_error("Binary graph weight types do not match the Graph types: " + file_name);
+		}
+		if (header.vertex_id_type != GetBinaryTypeTag<std::int32_t>() && header.vertex_id_type != GetBinaryTypeTag<std::int64_t>()) {
+			throw std::runtime_error("Unsupported binary graph vertex id type: " + file_name);
+		}
+
+		const std::uint64_t id_size = header.vertex_id_type & 0xFFu;
+		if (header.n < 0 || header.m < 0 ||
+			header.payload_size != getBinaryPayloadSize(header.n, header.m, id_size) ||
+			header.payload_size != file.size() - sizeof(header)) {
+			throw std::runtime_error("Binary graph file is truncated: " + file_name);
+		}
+		if (header.n > c<std::int64_t>(std::numeric_limits<idx_t>::max())) {
+			throw std::runtime_error("Binary graph has too many vertices for the vertex id type: " + file_name);
+		}
+
+		const std::byte* cursor = file.data() + sizeof(header);
+		if (GetChecksum(cursor, header.payload_size) != header.checksum) {
+			throw std::runtime_error("Binary graph checksum mismatch: " + file_name);
+		}
+
+		n = header.n;
+		m = header.m;
+
+		readBinarySection(cursor, xadj, n + 1_i);
+		if (header.vertex_id_type == GetBinaryTypeTag<idx_t>()) {
+			readBinarySection(cursor, adjncy, m);
+		}
+		else if (id_size == sizeof(std::int32_t)) {
+			readBinaryIds<std::int32_t>(cursor, adjncy, m);
+		}
+		else {
+			readBinaryIds<std::int64_t>(cursor, adjncy, m);
+		}
+		readBinarySection(cursor, vertex_weights, n);
+		readBinarySection(cursor, edge_weights, m);
+
+		if (ignore_eweights) {
+			std::fill(edge_weights.begin(), edge_weights.end(), c<ew_t>(1));
+		}
+	}
+
+	void buildGraph(MtxCSR<ew_t, idx_t>&& matrix, bool ignore_eweights) {
+		n = matrix.n;
+		m = matrix.xadj[n];
+
+		xadj = std::move(matrix.xadj);
+		adjncy = std::move(matrix.adjncy);
+
+		vertex_weights.assign(n, c<vw_t>(1));
+
+		if (ignore_eweights) {
+			edge_weights.assign(m, c<ew_t>(1));
+		}
+		else {
+			edge_weights = std::move(matrix.values);
+		}
+	}
+
 	void buildGraph(const spMtx<ew_t>& matrix, bool ignore_eweights) {
+		if (matrix.m > c<std::size_t>(std::numeric_limits<idx_t>::max())) {
+			throw std::runtime_error("Too many vertices for the vertex id type");
+		}
+
 		n = static_cast<int_t>(matrix.m);
 		m = static_cast<int_t>(matrix.nz);
 
 		adjncy.resize(m);
 		for (int_t i = 0_i; i < m; ++i) {
-			adjncy[i] = static_cast<int_t>(matrix.Col[i]);
+			adjncy[i] = static_cast<idx_t>(matrix.Col[i]);
 		}
 
 		xadj.resize(n + 1_i);
@@ -136,8 +270,24 @@ public:
 		buildGraph(matrix, ignore_eweights);
 	}
 
-	// Requires a matrix corresponding to an undirected graph
-	Graph(const String& file_name, const String& format, bool ignore_eweights = false) {
+	// Requires a matrix corresponding to an undirected graph.
+	// The "mtx" format is read by MtxReader with `threads_count` threads,
+	// other text formats by spMtx.
+	// The "bcsr" format is the binary CSR format written by saveBinary.
+	Graph(
+		const String& file_name,
+		const String& format,
+		bool		  ignore_eweights = false,
+		int_t		  threads_count = ProgramConfig::threads_count
+	) {
+		if (format == "bcsr") {
+			loadBinary(file_name, ignore_eweights);
+			return;
+		}
+		if (format == "mtx") {
+			buildGraph(MtxReader::Read<ew_t, idx_t>(file_name, threads_count), ignore_eweights);
+			return;
+		}
 		spMtx<ew_t> matrix(file_name.c_str(), format);
 		buildGraph(matrix, ignore_eweights);
 	}
@@ -146,6 +296,10 @@ public:
 		const Vector<vw_t>& vertex_weights,
 		const Vector<std::tuple<int_t, int_t, ew_t>>& edges
 	) {
+		if (vertex_weights.size() > c<std::size_t>(std::numeric_limits<idx_t>::max())) {
+			throw std::runtime_error("Too many vertices for the vertex id type");
+		}
+
 		n = static_cast<int_t>(vertex_weights.size());
 		this->vertex_weights = vertex_weights;
 
@@ -178,6 +332,42 @@ public:
 		}
 	}
 
+	// Writes the graph in the binary CSR format (see binary_graph.hpp),
+	// it can be loaded back with Graph(file_name, "bcsr").
+	void saveBinary(const String& file_name) const {
+		BinaryGraphHeader header;
+		std::memcpy(header.magic, BINARY_GRAPH_MAGIC, sizeof(header.magic));
+		header.version = BINARY_GRAPH_VERSION;
+		header.header_size = sizeof(header);
+		header.vertex_id_type = GetBinaryTypeTag<idx_t>();
+		header.reserved = 0u;
+		header.vertex_weight_type = GetBinaryTypeTag<vw_t>();
+		header.edge_weight_type = GetBinaryTypeTag<ew_t>();
+		header.n = n;
+		header.m = m;
+		header.payload_size = getBinaryPayloadSize(n, m, sizeof(idx_t));
+
+		header.checksum = GetChecksum(xadj.data(), xadj.size() * sizeof(int_t));
+		header.checksum = GetChecksum(adjncy.data(), adjncy.size() * sizeof(idx_t), header.checksum);
+		header.checksum = GetChecksum(vertex_weights.data(), vertex_weights.size() * sizeof(vw_t), header.checksum);
+		header.checksum = GetChecksum(edge_weights.data(), edge_weights.size() * sizeof(ew_t), header.checksum);
+
+		std::ofstream file(file_name, std::ios::binary);
+		if (!file) {
+			throw std::runtime_error("Can't create file " + file_name);
+		}
+
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		writeBinarySection(file, xadj);
+		writeBinarySection(file, adjncy);
+		writeBinarySection(file, vertex_weights);
+		writeBinarySection(file, edge_weights);
+
+		if (!file) {
+			throw std::runtime_error("Can't write file " + file_name);
+		}
+	}
+
 	int_t getVerticesCount() const noexcept {
 		return n;
 	}
@@ -188,67 +378,108 @@ public:
 
 	// This function returns a subgraph of the current graph, where
 	// the vertices were mapped according to the order in vertices.
-	Graph<vw_t, ew_t> selectSubgraph(const Vector<int_t>& vertices) const {
-		Graph<vw_t, ew_t> subgraph;
+	// Only the adjacency of the selected vertices is visited.
+	Graph<vw_t, ew_t, idx_t> selectSubgraph(const Vector<int_t>& vertices) const {
+		Instrumentation::ScopedTimer timer("select_subgraph");
 
-		std::unordered_map<int_t, int_t> original_to_sub;
-		for (int_t i = 0_i; i < vertices.size(); ++i) {
-			original_to_sub[vertices[i]] = i;
-		}
+		Graph<vw_t, ew_t, idx_t> subgraph;
 
-		subgraph.n = vertices.size();
+		// Dense original -> subgraph index, -1 for vertices that are not selected
+		Workspace::Buffer<int_t> original_to_sub_buffer(n, -1_i);
+		Vector<int_t>& original_to_sub = original_to_sub_buffer.get();
 
+		subgraph.n = vertices.size();
 		subgraph.vertex_weights.resize(subgraph.n);
-		for (int_t i = 0_i; i < vertices.size(); ++i) {
-			subgraph.vertex_weights[i] = vertex_weights[vertices[i]];
-		}
-
-		Vector<bool> is_exist(n, false);
 
-		for (int_t curr_V : vertices) {
-			is_exist[curr_V] = true;
-		}
-
-		for (int_t curr_V = 0_i; curr_V < n; ++curr_V) {
-			for (int_t i = xadj[curr_V]; i < xadj[curr_V + 1_i]; ++i) {
-				int_t next_V = adjncy[i];
-
-				if (is_exist[curr_V] && is_exist[next_V]) {
-					subgraph.m++;
-				}
-			}
+		int_t degrees_sum = 0_i;
+		for (int_t i = 0_i; i < subgraph.n; ++i) {
+			original_to_sub[vertices[i]] = i;
+			subgraph.vertex_weights[i] = vertex_weights[vertices[i]];
+			degrees_sum += xadj[vertices[i] + 1_i] - xadj[vertices[i]];
 		}
 
-		subgraph.adjncy.resize(subgraph.m);
-		subgraph.edge_weights.resize(subgraph.m);
-
 		subgraph.xadj.resize(subgraph.n + 1_i);
 		subgraph.xadj[0_i] = 0_i;
+		subgraph.adjncy.reserve(degrees_sum);
+		subgraph.edge_weights.reserve(degrees_sum);
 
-		int_t edge_pos = 0_i;
-
-		for (int_t i = 0_i; i < vertices.size(); ++i) {
+		for (int_t i = 0_i; i < subgraph.n; ++i) {
 			int_t curr_V = vertices[i];
-			subgraph.xadj[i + 1_i] = subgraph.xadj[i];
 			for (int_t k = xadj[curr_V]; k < xadj[curr_V + 1_i]; ++k) {
-				int_t next_V = adjncy[k];
+				int_t j = original_to_sub[adjncy[k]];
+				if (j != -1_i) {
+					subgraph.adjncy.push_back(j);
+					subgraph.edge_weights.push_back(edge_weights[k]);
+				}
+			}
+			subgraph.xadj[i + 1_i] = subgraph.adjncy.size();
+		}
+		subgraph.m = subgraph.adjncy.size();
 
-				if (is_exist[curr_V] && is_exist[next_V]) {
+		return subgraph;
+	}
 
-					int_t j = original_to_sub[next_V];
+	// This function splits the graph by a bipartition in one pass over the adjacency.
+	// 
+	// Parameters:
+	//   partition - part (0 or 1) of every vertex
+	//   part_vertices - filled with the original vertices of each part in increasing order
+	// 
+	// Returns:
+	//   both induced subgraphs, vertex i of part p is part_vertices[p][i]
+	//
+	std::pair<Graph<vw_t, ew_t, idx_t>, Graph<vw_t, ew_t, idx_t>> splitByBipartition(
+		const Vector<int_t>& partition,
+		Vector<int_t>	   (&part_vertices)[2]
+	) const {
+		Instrumentation::ScopedTimer timer("split_by_bipartition");
+
+		Graph<vw_t, ew_t, idx_t> parts[2];
+
+		// Index of every vertex inside its own part
+		Workspace::Buffer<int_t> local_index_buffer(n, 0_i);
+		Vector<int_t>& local_index = local_index_buffer.get();
+
+		int_t degrees_sum[2] = { 0_i, 0_i };
+		for (int_t p = 0_i; p < 2_i; ++p) {
+			part_vertices[p].clear();
+		}
+		for (int_t v = 0_i; v < n; ++v) {
+			int_t p = partition[v];
+			local_index[v] = part_vertices[p].size();
+			part_vertices[p].push_back(v);
+			degrees_sum[p] += xadj[v + 1_i] - xadj[v];
+		}
 
-					ew_t weight = edge_weights[k];
+		for (int_t p = 0_i; p < 2_i; ++p) {
+			parts[p].n = part_vertices[p].size();
+			parts[p].xadj.resize(parts[p].n + 1_i);
+			parts[p].xadj[0_i] = 0_i;
+			parts[p].vertex_weights.resize(parts[p].n);
+			parts[p].adjncy.reserve(degrees_sum[p]);
+			parts[p].edge_weights.reserve(degrees_sum[p]);
+		}
 
-					++subgraph.xadj[i + 1_i];
-					subgraph.adjncy[edge_pos] = j;
-					subgraph.edge_weights[edge_pos] = weight;
+		for (int_t v = 0_i; v < n; ++v) {
+			int_t p = partition[v];
+			Graph<vw_t, ew_t, idx_t>& part = parts[p];
 
-					++edge_pos;
+			for (int_t k = xadj[v]; k < xadj[v + 1_i]; ++k) {
+				int_t u = adjncy[k];
+				if (partition[u] == p) {
+					part.adjncy.push_back(local_index[u]);
+					part.edge_weights.push_back(edge_weights[k]);
 				}
 			}
+			part.vertex_weights[local_index[v]] = vertex_weights[v];
+			part.xadj[local_index[v] + 1_i] = part.adjncy.size();
 		}
 
-		return subgraph;
+		for (int_t p = 0_i; p < 2_i; ++p) {
+			parts[p].m = parts[p].adjncy.size();
+		}
+
+		return { std::move(parts[0]), std::move(parts[1]) };
 	}
 
 	void printEdges() const {
@@ -261,7 +492,7 @@ public:
 		}
 	}
 
-	bool operator==(const Graph<vw_t, ew_t>& other) const {
+	bool operator==(const Graph<vw_t, ew_t, idx_t>& other) const {
 		if (n != other.n || m != other.m) {
 			return false;
 		}
@@ -313,7 +544,7 @@ public:
 		return edges.empty();
 	}
 
-	bool operator!=(const Graph<vw_t, ew_t>& other) const {
+	bool operator!=(const Graph<vw_t, ew_t, idx_t>& other) const {
 		return !(*this == other);
 	}
 
@@ -328,23 +559,27 @@ public:
 	vw_t getVertexWeight(int_t v) const {
 		return vertex_weights[v];
 	}
+
+	int_t getDegree(int_t v) const {
+		return xadj[v + 1_i] - xadj[v];
+	}
 };
 
-template <typename vw_t, typename ew_t>
+template <typename vw_t, typename ew_t, typename idx_t>
 struct GraphTester {
-	static const Vector<int_t>& getAdjncy(const Graph<vw_t, ew_t>& g) {
+	static const Vector<idx_t>& getAdjncy(const Graph<vw_t, ew_t, idx_t>& g) {
 		return g.adjncy;
 	}
 
-	static const Vector<int_t>& getXadj(const Graph<vw_t, ew_t>& g) {
+	static const Vector<int_t>& getXadj(const Graph<vw_t, ew_t, idx_t>& g) {
 		return g.xadj;
 	}
 
-	static const Vector<vw_t>& getVertexWeights(const Graph<vw_t, ew_t>& g) {
+	static const Vector<vw_t>& getVertexWeights(const Graph<vw_t, ew_t, idx_t>& g) {
 		return g.vertex_weights;
 	}
 
-	static const Vector<vw_t>& getEdgeWeights(const Graph<vw_t, ew_t>& g) {
+	static const Vector<ew_t>& getEdgeWeights(const Graph<vw_t, ew_t, idx_t>& g) {
 		return g.edge_weights;
 	}
 };
\ No newline at end of file
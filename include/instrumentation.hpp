@@ -0,0 +1,195 @@
+#pragma once
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <ostream>
+
+#include "utils.hpp"
+
+// Hierarchical phase timers and counters of the partitioning pipeline.
+//
+// Every GetGraphKPartition call with `collect_instrumentation` set in its
+// options opens a session, a tree of named nodes. A ScopedTimer enters the child
+// node with its name (created on first use) for its lifetime and adds the
+// elapsed time to it, so repeated phases (e.g. the coarsening of every
+// bisection at the same recursion depth) are aggregated in one node.
+// Count() and Sample() attach values to the current node. When the session
+// ends the tree is stored as the last report and, if the session was given
+// an output, in it as well; the last report is shared by all threads, the
+// output belongs to one call.
+//
+// The current node is kept per thread. A task forked to another thread
+// takes the node of its parent with GetContext() / ScopedContext; nodes
+// are locked on update, so parallel tasks may share them. Times of the
+// children of a node may add up to more than its own time if they ran in
+// parallel.
+//
+// Outside of a session all calls return immediately. Building with
+// YAGKP_INSTRUMENTATION undefined removes the layer at compile time.
+//
+// Usage:
+//   Instrumentation::ScopedTimer timer("coarsening");
+//   Instrumentation::Count("moves", moves_count);
+//
+class Instrumentation {
+public:
+
+	// A counter (sum of the added values) or a sample (sum, minimum and maximum)
+	struct Statistic {
+		real_t sum = 0.0_r;
+		real_t min = 0.0_r;
+		real_t max = 0.0_r;
+		int_t  count = 0_i;
+		bool   is_sample = false;
+
+		real_t getMean() const {
+			return count > 0_i ? sum / c<real_t>(count) : 0.0_r;
+		}
+	};
+
+	struct Node {
+		String name;
+		int_t  calls = 0_i;
+		real_t time_ms = 0.0_r;
+
+		// In order of the first use
+		Vector<std::pair<String, Statistic>> values;
+		Vector<std::unique_ptr<Node>>		 children;
+
+		mutable std::mutex mutex;
+
+		Node* getChild(const String& child_name);
+		void  add(const String& value_name, real_t value, bool is_sample);
+		void  addTime(real_t elapsed_ms);
+
+		// nullptr if there is no such child / value
+		const Node*		 findChild(const String& child_name) const;
+		const Statistic* findValue(const String& value_name) const;
+	};
+
+	using Report = std::shared_ptr<const Node>;
+	using Context = Node*;
+
+	// Report of the last finished session, nullptr if there was none
+	static Report GetLastReport();
+
+	// Indented tree with times, call counts and values
+	static void PrintReport(std::ostream& out, const Node& report);
+	static void PrintReportJSON(std::ostream& out, const Node& report);
+
+#ifdef YAGKP_INSTRUMENTATION
+
+	static bool IsActive() noexcept {
+		return getCurrentNode() != nullptr;
+	}
+
+	static Context GetContext() noexcept {
+		return getCurrentNode();
+	}
+
+	static void Count(const char* name, real_t value = 1.0_r) {
+		if (Node* node = getCurrentNode()) {
+			node->add(name, value, false);
+		}
+	}
+
+	static void Sample(const char* name, real_t value) {
+		if (Node* node = getCurrentNode()) {
+			node->add(name, value, true);
+		}
+	}
+
+	class ScopedTimer {
+	private:
+
+		Node* parent = nullptr;
+		Node* node = nullptr;
+		std::chrono::steady_clock::time_point start;
+
+	public:
+
+		explicit ScopedTimer(const char* name);
+
+		// Node "<name> <index>", e.g. "level 3"
+		ScopedTimer(const char* name, int_t index);
+
+		ScopedTimer(const ScopedTimer&) = delete;
+		ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+		~ScopedTimer();
+
+	private:
+
+		void enter(const String& name);
+	};
+
+	// Makes `context` the current node of the calling thread for the lifetime of the object
+	class ScopedContext {
+	private:
+
+		Node* saved_node;
+
+	public:
+
+		explicit ScopedContext(Context context);
+
+		ScopedContext(const ScopedContext&) = delete;
+		ScopedContext& operator=(const ScopedContext&) = delete;
+
+		~ScopedContext();
+	};
+
+	// Root of a report, if `enabled`. Inside another session it is an ordinary
+	// timer and `output` is left unchanged.
+	class Session {
+	private:
+
+		std::shared_ptr<Node>	   root;
+		Report*					   output = nullptr;
+		std::optional<ScopedTimer> nested;
+		std::chrono::steady_clock::time_point start;
+
+	public:
+
+		Session(const char* name, bool enabled, Report* output = nullptr);
+
+		Session(const Session&) = delete;
+		Session& operator=(const Session&) = delete;
+
+		~Session();
+	};
+
+private:
+
+	static Node*& getCurrentNode() noexcept;
+
+#else
+
+	static bool IsActive() noexcept {
+		return false;
+	}
+
+	static Context GetContext() noexcept {
+		return nullptr;
+	}
+
+	static void Count(const char*, real_t = 1.0_r) {}
+	static void Sample(const char*, real_t) {}
+
+	struct ScopedTimer {
+		explicit ScopedTimer(const char*) {}
+		ScopedTimer(const char*, int_t) {}
+	};
+
+	struct ScopedContext {
+		explicit ScopedContext(Context) {}
+	};
+
+	struct Session {
+		Session(const char*, bool, Report* = nullptr) {}
+	};
+
+#endif
+};
@@ -19,10 +19,10 @@ public:
 	 * Returns:
 	 * - ew_t - total weight of all edges crossing partition boundaries										   | ex: ...
 	 */
-	template <typename vw_t, typename ew_t>
+	template <typename vw_t, typename ew_t, typename idx_t>
 	static ew_t GetEdgeCut(
-		const Graph<vw_t, ew_t>& graph,
-		const Vector<int_t>		 partition
+		const Graph<vw_t, ew_t, idx_t>& graph,
+		const Vector<int_t>&	 partition
 	) {
 		ew_t edge_cut = c<ew_t>(0);
 
@@ -51,9 +51,9 @@ public:
 	 * Returns:
 	 * - Vector<real_t> - output vector where i-th element stores the fraction of total weight				   | ex: {0.33, 0.33, 0.16, 0.16}
 	 */
-	template <typename vw_t, typename ew_t>
+	template <typename vw_t, typename ew_t, typename idx_t>
 	static Vector<real_t> GetBalances(
-		const Graph<ew_t, vw_t>& graph,
+		const Graph<ew_t, vw_t, idx_t>& graph,
 		const int_t				 k,
 		const Vector<int_t>&	 partition
 	) {
@@ -86,9 +86,9 @@ public:
 	 * Returns:
 	 * - real_t - the imbalance value (difference between the heaviest part and 1/k)							   | ex: 0.0833  -> 8.33% imbalance
 	 */
-	template <typename vw_t, typename ew_t>
+	template <typename vw_t, typename ew_t, typename idx_t>
 	static real_t GetAccuracy(
-		const Graph<vw_t, ew_t>& graph,
+		const Graph<vw_t, ew_t, idx_t>& graph,
 		const int_t				 k,
 		const Vector<int_t>&	 partition
 	) {
@@ -103,9 +103,9 @@ public:
 		return accuracy;
 	}
 
-	template <typename vw_t, typename ew_t>
+	template <typename vw_t, typename ew_t, typename idx_t>
 	static vw_t GetMaxPartWeight(
-		const Graph<ew_t, vw_t>& graph,
+		const Graph<ew_t, vw_t, idx_t>& graph,
 		const int_t				 k,
 		const Vector<int_t>& partition
 	) {
@@ -0,0 +1,330 @@
+#pragma once
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+
+#include "utils.hpp"
+#include "binary_graph.hpp"
+#include "thread_pool.hpp"
+
+// Graph read from a Matrix Market file, in CSR format.
+template <typename ValT, typename idx_t = int_t>
+struct MtxCSR {
+	int_t n = 0_i;
+
+	Vector<int_t> xadj;
+	Vector<idx_t> adjncy;
+	Vector<ValT>  values;
+};
+
+// Fast reader of coordinate Matrix Market files.
+//
+// The file is memory-mapped, its body is split between threads at line
+// boundaries and every part is parsed with std::from_chars. The CSR is then
+// built with a counting sort: the entries of every part are bucketed by
+// blocks of rows, and every block is then sorted by rows in parallel. The
+// order of the entries inside a row is the order of the file.
+//
+// The result is the same as the one of spMtx::read_mtx_to_crs:
+//   - only square "coordinate" matrices are accepted (no "complex" field)
+//   - self-loops are skipped
+//   - "symmetric" entries are stored in both directions, any other symmetry
+//     (general, skew-symmetric, hermitian) stores the entry as it is
+//   - "pattern" matrices get the value 1 for every entry
+//   - only the first nz entries of the body are read
+//
+class MtxReader {
+private:
+
+	struct Entry {
+		int_t row;
+		int_t col;
+		real_t value;
+	};
+
+	static bool isBlank(char symbol) {
+		return symbol == ' ' || symbol == '\t' || symbol == '\r';
+	}
+
+	static const char* skipBlanks(const char* curr, const char* end) {
+		while (curr < end && isBlank(*curr)) {
+			++curr;
+		}
+		return curr;
+	}
+
+	static const char* skipLine(const char* curr, const char* end) {
+		const void* line_end = std::memchr(curr, '\n', end - curr);
+		return line_end == nullptr ? end : static_cast<const char*>(line_end) + 1;
+	}
+
+	template <typename T>
+	static const char* parseNumber(const char* curr, const char* end, T& value) {
+		curr = skipBlanks(curr, end);
+
+		// from_chars does not accept a leading '+'
+		if (curr < end && *curr == '+') {
+			++curr;
+		}
+
+		std::from_chars_result result = std::from_chars(curr, end, value);
+		if (result.ec != std::errc()) {
+			throw std::runtime_error("Can't parse MTX number");
+		}
+		return result.ptr;
+	}
+
+	static String toLower(std::string_view word) {
+		String result(word);
+		for (char& symbol : result) {
+			symbol = static_cast<char>(std::tolower(static_cast<unsigned char>(symbol)));
+		}
+		return result;
+	}
+
+	// Parses the entries of [begin, end), which starts at a line boundary.
+	static void parseEntries(const char* begin, const char* end, bool is_pattern, Vector<Entry>& entries) {
+		const char* curr = begin;
+
+		while (curr < end) {
+			curr = skipBlanks(curr, end);
+			if (curr == end) {
+				break;
+			}
+			if (*curr == '\n' || *curr == '%') {
+				curr = skipLine(curr, end);
+				continue;
+			}
+
+			Entry entry;
+			curr = parseNumber(curr, end, entry.row);
+			curr = parseNumber(curr, end, entry.col);
+			entry.value = 1.0_r;
+			if (!is_pattern) {
+				curr = parseNumber(curr, end, entry.value);
+			}
+			entries.push_back(entry);
+
+			curr = skipLine(curr, end);
+		}
+	}
+
+public:
+
+	/*
+	 * Reads a square coordinate Matrix Market file into CSR.
+	 *
+	 * Parameters:
+	 * - file_name     - path to the .mtx file					  | ex: "../data/add20.mtx"
+	 * - threads_count - number of threads parsing the file		  | ex: 4
+	 *
+	 * Returns:
+	 * - MtxCSR<ValT, idx_t> - n, xadj, adjncy and values of the matrix
+	 *
+	 * Throws std::runtime_error if the file can't be read or has an unsupported type.
+	 */
+	template <typename ValT, typename idx_t = int_t>
+	static MtxCSR<ValT, idx_t> Read(const String& file_name, int_t threads_count) {
+		MappedFile file(file_name);
+
+		const char* curr = reinterpret_cast<const char*>(file.data());
+		const char* end = curr + file.size();
+
+		// Banner: %%MatrixMarket matrix coordinate <field> <symmetry>
+		const char* banner_end = skipLine(curr, end);
+		Vector<std::string_view> banner;
+		for (const char* word = curr; word < banner_end;) {
+			word = skipBlanks(word, banner_end);
+			const char* word_end = word;
+			while (word_end < banner_end && !isBlank(*word_end) && *word_end != '\n') {
+				++word_end;
+			}
+			if (word_end != word) {
+				banner.emplace_back(word, word_end - word);
+			}
+			word = word_end + 1;
+		}
+
+		if (banner.size() < 5 || toLower(banner[0]) != "%%matrixmarket" || toLower(banner[1]) != "matrix") {
+			throw std::runtime_error("Not a Matrix Market file: " + file_name);
+		}
+		if (toLower(banner[2]) != "coordinate" || toLower(banner[3]) == "complex") {
+			throw std::runtime_error("Unsupported Matrix Market type: " + file_name);
+		}
+
+		const bool is_pattern = (toLower(banner[3]) == "pattern");
+		const bool is_symmetric = (toLower(banner[4]) == "symmetric");
+
+		// Comments, then the size line
+		curr = banner_end;
+		while (curr < end) {
+			const char* line = skipBlanks(curr, end);
+			if (line < end && *line != '%' && *line != '\n') {
+				break;
+			}
+			curr = skipLine(curr, end);
+		}
+
+		int_t rows_count, cols_count, nz;
+		curr = parseNumber(curr, end, rows_count);
+		curr = parseNumber(curr, end, cols_count);
+		curr = parseNumber(curr, end, nz);
+		curr = skipLine(curr, end);
+
+		if (rows_count != cols_count) {
+			throw std::runtime_error("Is not a square matrix: " + file_name);
+		}
+		if (rows_count > c<int_t>(std::numeric_limits<idx_t>::max())) {
+			throw std::runtime_error("Too many vertices for the vertex id type: " + file_name);
+		}
+
+		const int_t n = rows_count;
+
+		// 1. Parsing of the parts
+		std::shared_ptr<ThreadPool> pool = ThreadPool::GetInstance(threads_count);
+
+		// Parts are at most 4 GiB, so that the index of an entry in its part fits in 31 bits
+		const int_t parts_count = std::max<int_t>(
+			((end - curr) >> 32) + 1_i,
+			std::min<int_t>(pool->getThreadsCount(), (end - curr) / (1_i << 16))
+		);
+
+		Vector<const char*> bounds(parts_count + 1_i);
+		bounds[0] = curr;
+		bounds[parts_count] = end;
+		for (int_t p = 1_i; p < parts_count; ++p) {
+			const char* bound = curr + (end - curr) * p / parts_count;
+			bounds[p] = std::max(bounds[p - 1_i], skipLine(std::max(bound - 1, curr), end));
+		}
+
+		Vector<Vector<Entry>> entries(parts_count);
+
+		pool->ParallelFor(0_i, parts_count, 1_i, [&](int_t p) {
+			parseEntries(bounds[p], bounds[p + 1_i], is_pattern, entries[p]);
+		});
+
+		// Only the first nz entries are the matrix
+		int_t read_count = 0_i;
+		for (int_t p = 0_i; p < parts_count; ++p) {
+			int_t kept = std::min<int_t>(entries[p].size(), nz - read_count);
+			entries[p].resize(kept);
+			read_count += kept;
+		}
+		if (read_count < nz) {
+			throw std::runtime_error("Unexpected end of MTX file: " + file_name);
+		}
+
+		pool->ParallelFor(0_i, parts_count, 1_i, [&](int_t p) {
+			for (const Entry& entry : entries[p]) {
+				if (entry.row < 1_i || entry.row > n || entry.col < 1_i || entry.col > n) {
+					throw std::runtime_error("MTX entry is out of range");
+				}
+			}
+		});
+
+		// 2. Bucketing by row blocks
+		//
+		// Every stored entry (both directions of a symmetric one) gets a code:
+		// its index in the part and whether it is transposed. The codes are
+		// grouped by blocks of consecutive rows, inside a block by part and
+		// inside a part in the order of the file. The scratch memory is one
+		// 4-byte code per stored entry and a counter per part and block.
+		const int_t block_rows = 1_i << 14;
+		const int_t blocks_count = std::max<int_t>(1_i, (n + block_rows - 1_i) / block_rows);
+
+		auto for_each_stored = [&](const Entry& entry, auto&& function) {
+			if (entry.row == entry.col) return;
+			function(entry.row - 1_i, std::uint32_t(0));
+			if (is_symmetric) {
+				function(entry.col - 1_i, std::uint32_t(1));
+			}
+		};
+
+		// bucket_start[b * parts_count + p] is the number of codes of the part p
+		// in the block b, then the position of the first of them
+		Vector<int_t> bucket_start(blocks_count * parts_count + 1_i, 0_i);
+
+		pool->ParallelFor(0_i, parts_count, 1_i, [&](int_t p) {
+			for (const Entry& entry : entries[p]) {
+				for_each_stored(entry, [&](int_t row, std::uint32_t) {
+					++bucket_start[row / block_rows * parts_count + p];
+				});
+			}
+		});
+
+		int_t stored_count = 0_i;
+		for (int_t& start : bucket_start) {
+			const int_t count = start;
+			start = stored_count;
+			stored_count += count;
+		}
+
+		Vector<std::uint32_t> codes(stored_count);
+
+		pool->ParallelFor(0_i, parts_count, 1_i, [&](int_t p) {
+			Vector<int_t> cursor(blocks_count);
+			for (int_t b = 0_i; b < blocks_count; ++b) {
+				cursor[b] = bucket_start[b * parts_count + p];
+			}
+
+			for (std::size_t i = 0; i < entries[p].size(); ++i) {
+				for_each_stored(entries[p][i], [&](int_t row, std::uint32_t transposed) {
+					codes[cursor[row / block_rows]++] = (static_cast<std::uint32_t>(i) << 1) | transposed;
+				});
+			}
+		});
+
+		// 3. Counting sort of every block, the order of the codes is kept inside a row
+		MtxCSR<ValT, idx_t> csr;
+		csr.n = n;
+		csr.xadj.assign(n + 1_i, 0_i);
+		csr.adjncy.resize(stored_count);
+		csr.values.resize(stored_count);
+
+		pool->ParallelFor(0_i, blocks_count, 1_i, [&](int_t b) {
+			const int_t first_row = b * block_rows;
+			const int_t last_row = std::min(n, first_row + block_rows);
+
+			auto for_each_code = [&](auto&& function) {
+				for (int_t p = 0_i; p < parts_count; ++p) {
+					const int_t bucket = b * parts_count + p;
+					for (int_t j = bucket_start[bucket]; j < bucket_start[bucket + 1_i]; ++j) {
+						const Entry& entry = entries[p][codes[j] >> 1];
+						if (codes[j] & 1u) {
+							function(entry.col - 1_i, entry.row - 1_i, entry.value);
+						}
+						else {
+							function(entry.row - 1_i, entry.col - 1_i, entry.value);
+						}
+					}
+				}
+			};
+
+			Vector<int_t> offset(last_row - first_row + 1_i, 0_i);
+			for_each_code([&](int_t row, int_t, real_t) {
+				++offset[row - first_row + 1_i];
+			});
+
+			offset[0] = bucket_start[b * parts_count];
+			for (int_t row = first_row; row < last_row; ++row) {
+				offset[row - first_row + 1_i] += offset[row - first_row];
+				csr.xadj[row + 1_i] = offset[row - first_row + 1_i];
+			}
+
+			for_each_code([&](int_t row, int_t col, real_t value) {
+				const int_t position = offset[row - first_row]++;
+				csr.adjncy[position] = static_cast<idx_t>(col);
+				csr.values[position] = static_cast<ValT>(value);
+			});
+		});
+
+		return csr;
+	}
+};
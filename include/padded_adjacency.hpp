@@ -0,0 +1,147 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+#include "config.hpp"
+
+#include "utils.hpp"
+#include "graph.hpp"
+#include "workspace.hpp"
+
+// Masked argmax over a row of neighbours, the inner loop of heavy edge and
+// heavy clique matching.
+//
+// Position i of a row is eligible if its neighbour ids[i] can still be added
+// to the vertex, i.e.
+//   weights[ids[i]] <= limit                    (integral vertex weights)
+//   !(own_weight + weights[ids[i]] > limit)     (floating point vertex weights)
+// where `weights` holds the weights of the unmatched vertices and a value
+// above any limit for the matched ones. Find returns the first position with
+// the largest rating among the eligible ones, -1 if there is none.
+//
+// `count` must be a multiple of PaddedAdjacency::Width. The set is resolved
+// with Resolve, and the kernels of every set return the same position.
+// Loops over many rows take the kernel once with GetIntegralKernel /
+// GetFloatingKernel instead of calling Find for every row.
+class MaskedArgMax {
+public:
+
+	using IntegralKernel = int_t (*)(const std::int32_t* ids, const real_t* ratings, int_t count, const int_t* weights, int_t limit);
+	using FloatingKernel = int_t (*)(const std::int32_t* ids, const real_t* ratings, int_t count, const real_t* weights, real_t own_weight, real_t limit);
+
+	// The widest set supported by both the build and the processor
+	static ProgramConfig::InstructionSet GetSupported();
+
+	// `requested`, or the widest supported set below it
+	static ProgramConfig::InstructionSet Resolve(ProgramConfig::InstructionSet requested);
+
+	static const char* GetName(ProgramConfig::InstructionSet set);
+
+	// Kernel of the set resolved with Resolve
+	static IntegralKernel GetIntegralKernel(ProgramConfig::InstructionSet set);
+	static FloatingKernel GetFloatingKernel(ProgramConfig::InstructionSet set);
+
+	static int_t Find(
+		ProgramConfig::InstructionSet set,
+		const std::int32_t*			  ids,
+		const real_t*				  ratings,
+		int_t						  count,
+		const int_t*				  weights,
+		int_t						  limit
+	);
+
+	static int_t Find(
+		ProgramConfig::InstructionSet set,
+		const std::int32_t*			  ids,
+		const real_t*				  ratings,
+		int_t						  count,
+		const real_t*				  weights,
+		real_t						  own_weight,
+		real_t						  limit
+	);
+};
+
+// Copy of the adjacency of a graph for vectorized scans.
+//
+// The neighbours of every vertex are stored as split arrays of ids and
+// ratings (structure of arrays). Every row starts at a multiple of `Width`
+// and is padded up to the next one; padding refers to the vertex itself and
+// has the rating -inf, so it never wins a maximum. Rows keep the order of
+// the CSR graph, so positions in a row are positions in graph[v] as well.
+// The arrays are borrowed from the workspace of the calling thread.
+//
+// Usage:
+//   PaddedAdjacency adjacency;
+//   adjacency.build(graph, [](int_t curr_V, int_t next_V, ew_t w) { return c<real_t>(w); });
+//   MaskedArgMax::IntegralKernel kernel = MaskedArgMax::GetIntegralKernel(set);
+//   int_t position = adjacency.find(kernel, curr_V, free_weights.data(), limit);
+//
+class PaddedAdjacency {
+public:
+
+	// Doubles in an AVX-512 register, two AVX2 registers
+	static constexpr int_t Width = 8_i;
+
+private:
+
+	Workspace::Buffer<int_t>		offsets_buffer;	// size n + 1
+	Workspace::Buffer<std::int32_t> ids_buffer;
+	Workspace::Buffer<real_t>		ratings_buffer;
+
+	// A NaN or -inf rating can't be compared the way the scalar matching does
+	bool ordered = true;
+
+public:
+
+	// `rating(curr_V, next_V, w)` is the value maximized by find
+	template <typename vw_t, typename ew_t, typename idx_t, typename Rating>
+	void build(const Graph<vw_t, ew_t, idx_t>& graph, const Rating& rating) {
+		const int_t n = graph.getVerticesCount();
+
+		Vector<int_t>& offsets = offsets_buffer.get();
+		Vector<std::int32_t>& ids = ids_buffer.get();
+		Vector<real_t>& ratings = ratings_buffer.get();
+
+		offsets.resize(n + 1_i);
+		offsets[0] = 0_i;
+		for (int_t v = 0_i; v < n; ++v) {
+			offsets[v + 1_i] = offsets[v] + (graph.getDegree(v) + Width - 1_i) / Width * Width;
+		}
+
+		ids.resize(offsets[n]);
+		ratings.resize(offsets[n]);
+		ordered = true;
+
+		for (int_t v = 0_i; v < n; ++v) {
+			int_t pos = offsets[v];
+			for (auto [u, w] : graph[v]) {
+				ids[pos] = static_cast<std::int32_t>(u);
+				ratings[pos] = rating(v, u, w);
+				ordered = ordered && !std::isnan(ratings[pos]) && ratings[pos] != -std::numeric_limits<real_t>::infinity();
+				++pos;
+			}
+			for (; pos < offsets[v + 1_i]; ++pos) {
+				ids[pos] = static_cast<std::int32_t>(v);
+				ratings[pos] = -std::numeric_limits<real_t>::infinity();
+			}
+		}
+	}
+
+	// Whether find gives the same result as a scalar scan with `>` comparisons
+	bool isOrdered() const {
+		return ordered;
+	}
+
+	// Position of the best eligible neighbour of `v` in its row, -1 if there is none
+	int_t find(MaskedArgMax::IntegralKernel kernel, int_t v, const int_t* weights, int_t limit) const {
+		const Vector<int_t>& offsets = offsets_buffer.get();
+		return kernel(ids_buffer.get().data() + offsets[v], ratings_buffer.get().data() + offsets[v], offsets[v + 1_i] - offsets[v], weights, limit);
+	}
+
+	int_t find(MaskedArgMax::FloatingKernel kernel, int_t v, const real_t* weights, real_t own_weight, real_t limit) const {
+		const Vector<int_t>& offsets = offsets_buffer.get();
+		return kernel(ids_buffer.get().data() + offsets[v], ratings_buffer.get().data() + offsets[v], offsets[v + 1_i] - offsets[v], weights, own_weight, limit);
+	}
+};
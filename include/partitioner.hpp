@@ -1,5 +1,8 @@
 #pragma once
 
+#include <cmath>
+#include <optional>
+
 #include "utils.hpp"
 
 #include "graph.hpp"
@@ -10,56 +13,140 @@
 #include "post_processing.hpp"
 
 #include "metrics.hpp"
-
-class Partitioner {
+#include "instrumentation.hpp"
+#include "thread_pool.hpp"
+
+// Multilevel partitioner with the phase strategies fixed at compile time.
+//
+// `Matching` builds the coarse levels (see MatchingStrategy), `InitialPartitioner`
+// bisects the coarsest graph (see BipartitioningStrategy) and `Refiner` refines
+// the bisection on every level while uncoarsening (see RefinementStrategy).
+// Calls to the strategies are resolved statically, so each combination is
+// compiled separately and its inner loops can be inlined and specialised.
+// The methods of `options` that select these strategies are ignored.
+//
+// Usage:
+//   BasicPartitioner<
+//       MatchingStrategy<ProgramConfig::CoarseningMethod::HeavyEdgeMatching>,
+//       BipartitioningStrategy<ProgramConfig::BipartitioningMethod::GreedyGraphGrowingAlgorithm>,
+//       RefinementStrategy<ProgramConfig::UncoarseningMethod::FiducciaMattheyses>
+//   >::GetGraphKPartition(graph, k, partition);
+//
+template <typename Matching, typename InitialPartitioner, typename Refiner>
+class BasicPartitioner {
 public:
 
-	template <typename vw_t, typename ew_t>
+	template <typename vw_t, typename ew_t, typename idx_t>
 	static void GetGraphKPartition(
-		const Graph<vw_t, ew_t>& graph,
+		const Graph<vw_t, ew_t, idx_t>& graph,
 		const int_t              k,
-		      Vector<int_t>&     partition
+		      Vector<int_t>&     partition,
+		const PartitionerOptions& options = PartitionerOptions()
 	) {
+		// With options.collect_instrumentation the phase report of this call is
+		// stored in options.instrumentation_report and Instrumentation::GetLastReport()
+		Instrumentation::Session session("GetGraphKPartition", options.collect_instrumentation, options.instrumentation_report);
+
+		std::optional<ScopedRandomSeed> seed;
+		if (options.random_seed >= 0_i) {
+			seed.emplace(static_cast<std::uint64_t>(options.random_seed));
+		}
+
 		partition.resize(graph.n, -1_i);
-		RecursivePartition<vw_t, ew_t>(graph, k, partition, 0_i);
 
-		PostProcessor::FixPartitionDisbalance<vw_t, ew_t>(graph, k, partition);
+		// Imbalances of nested bisections multiply, so each of the
+		// ceil(log2(k)) levels of recursion gets its share of the tolerance
+		const real_t bisection_accuracy = (k > 1_i)
+			? std::pow(1.0_r + options.accuracy, 1.0_r / std::ceil(std::log2(c<real_t>(k)))) - 1.0_r
+			: options.accuracy;
+
+		std::shared_ptr<ThreadPool> pool = ThreadPool::GetInstance(options.threads_count);
+
+		switch (options.partitioning_method) {
+		case ProgramConfig::PartitioningMethod::RecursiveBisection:
+			RecursivePartition<vw_t, ew_t>(graph, k, partition, 0_i, bisection_accuracy, *pool, options);
+			break;
+		case ProgramConfig::PartitioningMethod::DirectKWay:
+			DirectKWayPartition<vw_t, ew_t>(graph, k, partition, bisection_accuracy, *pool, options);
+			break;
+
+		default:
+			throw std::runtime_error("Unknown partitioning method in PartitionerOptions.");
+		}
+
+		{
+			Instrumentation::ScopedTimer timer("post_processing");
+			PostProcessor::FixPartitionDisbalance<vw_t, ew_t>(graph, k, partition, options);
+			PostProcessor::ImproveFinalPartition<vw_t, ew_t>(graph, k, partition, options);
+		}
 	}
 
-    template <typename vw_t, typename ew_t>
+    // Multilevel k-way scheme: the graph is coarsened once, the coarsest graph
+    // is split by recursive bisection, and the k-way partition is refined
+    // on every level while uncoarsening.
+    template <typename vw_t, typename ew_t, typename idx_t>
+    static void DirectKWayPartition(
+        const Graph<vw_t, ew_t, idx_t>& graph,
+        const int_t              k,
+              Vector<int_t>&     partition,
+        const real_t             bisection_accuracy,
+              ThreadPool&        pool,
+        const PartitionerOptions& options
+    ) {
+        const int_t vertices_limit = std::max(
+            options.coarsening_vertix_count_limit,
+            k * options.partitioning_DirectKWay_vertices_per_part
+        );
+
+        Vector<CoarseLevel<vw_t, ew_t, idx_t>> levels = Coarser::GetCoarseLevels<Matching>(graph, k, vertices_limit, options);
+
+        const Graph<vw_t, ew_t, idx_t>& coarse_graph = levels.back().getGraph();
+
+        Vector<int_t> coarse_partition(coarse_graph.n, -1_i);
+        {
+            Instrumentation::ScopedTimer timer("initial_partitioning");
+            RecursivePartition<vw_t, ew_t>(coarse_graph, k, coarse_partition, 0_i, bisection_accuracy, pool, options);
+        }
+
+        Uncoarser::RestoreKWayPartition<vw_t, ew_t>(levels, k, coarse_partition, options.accuracy, options);
+
+        partition = std::move(coarse_partition);
+    }
+
+    template <typename vw_t, typename ew_t, typename idx_t>
     static void RecursivePartition(
-        const Graph<vw_t, ew_t>& graph,
+        const Graph<vw_t, ew_t, idx_t>& graph,
         const int_t              k,
               Vector<int_t>&     partition,
-              int_t              offset
+              int_t              offset,
+        const real_t             bisection_accuracy,
+              ThreadPool&        pool,
+        const PartitionerOptions& options
     ) {
         if (k == 1_i) {
             std::fill(partition.begin(), partition.end(), offset);
             return;
         }
 
-        Vector<CoarseLevel<vw_t, ew_t>> levels = Coarser::GetCoarseLevels(graph, k);
+        Instrumentation::ScopedTimer timer("recursive_bisection");
+
+        Vector<CoarseLevel<vw_t, ew_t, idx_t>> levels = Coarser::GetCoarseLevels<Matching>(graph, k, options.coarsening_vertix_count_limit, options);
 
-        const Graph<vw_t, ew_t>& coarse_graph = levels.back().coarsed_graph;
+        const Graph<vw_t, ew_t, idx_t>& coarse_graph = levels.back().getGraph();
 
         Vector<int_t> coarse_partition;
    
-        Bipartitioner::GetGraphBipartition(coarse_graph, coarse_partition);
-		Uncoarser::RestorePartition<vw_t, ew_t>(levels, coarse_partition);
+        Bipartitioner::GetGraphBipartition<InitialPartitioner>(coarse_graph, coarse_partition, options);
+		Uncoarser::RestorePartition<Refiner>(levels, coarse_partition, bisection_accuracy, options);
 
-        Vector<int_t> left_part_vertices, right_part_vertices;
-        for (int_t i = 0_i; i < graph.n; ++i) {
-            if (coarse_partition[i] == 0_i) {
-                left_part_vertices.push_back(i);
-            }
-            else {
-                right_part_vertices.push_back(i);
-            }
-        }
+        Vector<int_t> part_vertices[2];
+        std::pair<Graph<vw_t, ew_t, idx_t>, Graph<vw_t, ew_t, idx_t>> halves = graph.splitByBipartition(coarse_partition, part_vertices);
 
-        Graph<vw_t, ew_t> left_graph = graph.selectSubgraph(left_part_vertices);
-        Graph<vw_t, ew_t> right_graph = graph.selectSubgraph(right_part_vertices);
+        const Graph<vw_t, ew_t, idx_t>& left_graph = halves.first;
+        const Graph<vw_t, ew_t, idx_t>& right_graph = halves.second;
 
+        const Vector<int_t>& left_part_vertices = part_vertices[0];
+        const Vector<int_t>& right_part_vertices = part_vertices[1];
 
         vw_t total_W = graph.getSumOfVertexWeights();
         vw_t left_W = left_graph.getSumOfVertexWeights();
@@ -74,8 +161,27 @@ public:
         Vector<int_t> left_part(left_graph.n, -1_i);
         Vector<int_t> right_part(right_graph.n, -1_i);
 
-        RecursivePartition<vw_t, ew_t>(left_graph, left_k, left_part, offset);
-        RecursivePartition<vw_t, ew_t>(right_graph, right_k, right_part, offset + left_k);
+        // Both halves are independent subproblems. Each of them gets its own
+        // random stream, so the result is the same for any number of threads.
+        const std::uint64_t children_seed = GetRandomSeed();
+        const std::uint64_t left_seed = DeriveRandomSeed(children_seed, 0);
+        const std::uint64_t right_seed = DeriveRandomSeed(children_seed, 1);
+
+        // Forked subproblems report into the node of this bisection
+        Instrumentation::Context context = Instrumentation::GetContext();
+
+        pool.ForkJoin(
+            [&]() {
+                ScopedRandomSeed seed(left_seed);
+                Instrumentation::ScopedContext scoped_context(context);
+                RecursivePartition<vw_t, ew_t>(left_graph, left_k, left_part, offset, bisection_accuracy, pool, options);
+            },
+            [&]() {
+                ScopedRandomSeed seed(right_seed);
+                Instrumentation::ScopedContext scoped_context(context);
+                RecursivePartition<vw_t, ew_t>(right_graph, right_k, right_part, offset + left_k, bisection_accuracy, pool, options);
+            }
+        );
 
         for (int_t i = 0_i; i < left_part_vertices.size(); ++i) {
             partition[left_part_vertices[i]] = left_part[i];
@@ -85,4 +191,26 @@ public:
             partition[right_part_vertices[i]] = right_part[i];
         }
     }
+};
+
+// Partitioner configured at runtime by the methods of `options`.
+// It dispatches to the matching BasicPartitioner once per call.
+class Partitioner {
+public:
+
+	template <typename vw_t, typename ew_t, typename idx_t>
+	static void GetGraphKPartition(
+		const Graph<vw_t, ew_t, idx_t>& graph,
+		const int_t              k,
+		      Vector<int_t>&     partition,
+		const PartitionerOptions& options = PartitionerOptions()
+	) {
+		Coarser::VisitMatchingStrategy(options.coarsening_method, [&]<typename Matching>() {
+			Bipartitioner::VisitBipartitioningStrategy(options.bipartitioning_method, [&]<typename InitialPartitioner>() {
+				Uncoarser::VisitRefinementStrategy(options.uncoarsening_method, [&]<typename Refiner>() {
+					BasicPartitioner<Matching, InitialPartitioner, Refiner>::GetGraphKPartition(graph, k, partition, options);
+				});
+			});
+		});
+	}
 };
\ No newline at end of file
@@ -5,23 +5,31 @@
 #include "graph.hpp"
 #include "config.hpp"
 #include "heap.hpp"
+#include "instrumentation.hpp"
+#include "thread_pool.hpp"
+#include "workspace.hpp"
 
+#include <numeric>
 #include <unordered_set>
 #include <queue>
 
 class PostProcessor {
 public:
 
-	template <typename vw_t, typename ew_t>
+	template <typename vw_t, typename ew_t, typename idx_t>
 	static void FixPartitionDisbalance(
-		const Graph<vw_t, ew_t>& graph,
+		const Graph<vw_t, ew_t, idx_t>& graph,
 		const int_t              k,
-		Vector<int_t>&			 partition
+		Vector<int_t>&			 partition,
+		const PartitionerOptions& options = PartitionerOptions()
 	) {
-		if (!ProgramConfig::post_processing_disbalance_fix) {
+		if (!options.post_processing_disbalance_fix) {
 			return;
 		}
 
+		Instrumentation::ScopedTimer timer("disbalance_fix");
+		int_t moves_count = 0_i;
+
 		Vector<vw_t> comp_weight(k, 0);
 		int_t n = graph.getVerticesCount();
 		for (int_t v = 0; v < n; ++v) {
@@ -29,7 +37,7 @@ public:
 		}
 
 		vw_t total_weight = graph.getSumOfVertexWeights();
-        vw_t max_allowed = c<vw_t>(c<real_t>(total_weight) / c<real_t>(k) * (1.0_r + ProgramConfig::accuracy + EPS));
+        vw_t max_allowed = c<vw_t>(c<real_t>(total_weight) / c<real_t>(k) * (1.0_r + options.accuracy + EPS));
 
 		while (max_allowed * c<vw_t>(k) < total_weight) {
 			max_allowed += c<vw_t>(1);
@@ -40,7 +48,7 @@ public:
             comp_vertices[partition[v]].push_back(v);
         }
 
-        IndexedHeap<vw_t, std::greater<vw_t>> heap(k);
+        DaryIndexedHeap<vw_t, std::greater<vw_t>> heap(k);
         for (int_t c = 0; c < k; ++c) {
             heap.push(comp_weight[c], c);
         }
@@ -81,71 +89,214 @@ public:
 
 			heap.changePriority(comp_weight[c_idx], c_idx);
 			heap.changePriority(comp_weight[target], target);
+
+			++moves_count;
         }
+
+		Instrumentation::Count("moves", c<real_t>(moves_count));
 	}
 
-	template <typename vw_t, typename ew_t>
+	// Parallel k-way label propagation.
+	//
+	// Every round consists of three phases over the active vertices:
+	//   1. each vertex collects its connectivity to the adjacent parts in one
+	//      adjacency scan and picks the part with the largest positive gain;
+	//   2. a proposal is independent if no neighbour of the vertex proposes a
+	//      move too, so its gain stays exact when all of them are applied. The
+	//      independent moves to parts that can take their whole inflow are
+	//      applied at once;
+	//   3. the remaining proposals are checked one by one in vertex order, with
+	//      the gain recomputed against the current partition.
+	// Every applied move has a positive gain, so the edge cut never increases.
+	// The adjacency scans run in parallel and only read the partition; part
+	// weights are summed sequentially in vertex order, so the result does not
+	// depend on the number of threads, also for floating point weights.
+	// Moved vertices and their neighbours are the active vertices of the next round.
+	template <typename vw_t, typename ew_t, typename idx_t>
 	static void ImproveFinalPartition(
-		const Graph<vw_t, ew_t>& graph,
+		const Graph<vw_t, ew_t, idx_t>& graph,
 		const int_t              k,
-		Vector<int_t>& partition
+		Vector<int_t>& partition,
+		const PartitionerOptions& options = PartitionerOptions()
 	) {
-		if (!ProgramConfig::post_processing_improvement) {
+		if (!options.post_processing_improvement) {
 			return;
 		}
+
+		Instrumentation::ScopedTimer timer("improvement");
+		int_t rounds_count = 0_i;
+		int_t moves_count = 0_i;
         int_t n = graph.getVerticesCount();
 
-        Vector<vw_t> comp_weight(k, 0);
+        std::shared_ptr<ThreadPool> pool = ThreadPool::GetInstance(options.threads_count);
+        const int_t grain_size = 1024_i;
+
+        Vector<vw_t> comp_weight(k, c<vw_t>(0));
         for (int_t v = 0; v < n; ++v) {
             comp_weight[partition[v]] += graph.getVertexWeight(v);
         }
 
         vw_t total_weight = graph.getSumOfVertexWeights();
-        vw_t max_allowed = c<vw_t>((c<real_t>(total_weight) / c<real_t>(k)) * (1.0_r + ProgramConfig::accuracy + EPS));
+        vw_t max_allowed = c<vw_t>((c<real_t>(total_weight) / c<real_t>(k)) * (1.0_r + options.accuracy + EPS));
 
 
 		while (max_allowed * c<vw_t>(k) < total_weight) {
 			max_allowed += c<vw_t>(1);
 		}
 
-		std::queue<int_t> vertices_queue;
-		for (int_t i = 0; i < n; ++i) {
-			vertices_queue.push(i);
-		}
+        Workspace::Buffer<int_t> active_buffer(n, 0_i);
+        Vector<int_t>& active = active_buffer.get();
+        std::iota(active.begin(), active.end(), 0_i);
+
+        Workspace::Buffer<int_t> target_buffer(n, -1_i);
+        Vector<int_t>& target = target_buffer.get();
+
+        Workspace::Buffer<char> independent_buffer(n, 0);
+        Vector<char>& independent = independent_buffer.get();
+
+        Vector<vw_t> inflow(k, c<vw_t>(0));
+        Vector<char> accepts_all(k);
 
-        while (!vertices_queue.empty()) {
-			int_t v = vertices_queue.front(); vertices_queue.pop();
-            int_t curr_comp = partition[v];
-            vw_t vertex_w = graph.getVertexWeight(v);
+        Workspace::Buffer<int_t> round_mark_buffer(n, -1_i);
+        Workspace::Buffer<int_t> next_active_buffer;
 
-            int_t best_target = curr_comp;
-            ew_t best_gain = 0;
+        Vector<int_t>& round_mark = round_mark_buffer.get();
+        Vector<int_t>& next_active = next_active_buffer.get();
 
-            for (int_t t = 0; t < k; ++t) {
-                if (t == curr_comp) continue;
-                if (comp_weight[t] + vertex_w > max_allowed) continue;
+        for (int_t round = 0_i; round < options.post_processing_improvement_rounds_limit && !active.empty(); ++round) {
+            ++rounds_count;
 
-                ew_t cut_before = 0;
-                ew_t cut_after = 0;
+            // 1. Proposals
+            pool->ParallelFor(0_i, active.size(), grain_size, [&](int_t i) {
+                thread_local Vector<ew_t> connectivity;
+                thread_local Vector<int_t> adjacent_parts;
+
+                if (static_cast<int_t>(connectivity.size()) < k) {
+                    connectivity.assign(k, c<ew_t>(0));
+                }
+                adjacent_parts.clear();
+
+                const int_t v = active[i];
+                const int_t curr_comp = partition[v];
+                const vw_t vertex_w = graph.getVertexWeight(v);
 
                 for (auto [u, w] : graph[v]) {
-                    if (partition[u] == curr_comp) cut_before += w;
-                    if (partition[u] == t)         cut_after += w;
+                    const int_t part = partition[u];
+                    if (connectivity[part] == c<ew_t>(0)) {
+                        adjacent_parts.push_back(part);
+                    }
+                    connectivity[part] += w;
                 }
 
-                ew_t gain = c<ew_t>(cut_after - cut_before);
-                if (gain > best_gain) {
-                    best_gain = gain;
-                    best_target = t;
+                int_t best_target = -1_i;
+                ew_t best_gain = c<ew_t>(0);
+                vw_t best_weight = c<vw_t>(0);
+
+                for (int_t t : adjacent_parts) {
+                    if (t == curr_comp) continue;
+
+                    const vw_t weight = comp_weight[t];
+                    if (weight + vertex_w > max_allowed) continue;
+
+                    const ew_t gain = connectivity[t] - connectivity[curr_comp];
+                    if (gain > best_gain || (gain == best_gain && best_target != -1_i && weight < best_weight)) {
+                        best_target = t;
+                        best_gain = gain;
+                        best_weight = weight;
+                    }
+                }
+
+                for (int_t part : adjacent_parts) {
+                    connectivity[part] = c<ew_t>(0);
+                }
+
+                target[v] = best_target;
+            });
+
+            // 2. Independent moves to parts that can take every independent vertex
+            pool->ParallelFor(0_i, active.size(), grain_size, [&](int_t i) {
+                const int_t v = active[i];
+                if (target[v] == -1_i) return;
+
+                bool is_independent = true;
+                for (auto [u, w] : graph[v]) {
+                    if (u != v && target[u] != -1_i) {
+                        is_independent = false;
+                        break;
+                    }
+                }
+                independent[v] = is_independent;
+            });
+
+            for (int_t v : active) {
+                if (target[v] != -1_i && independent[v]) {
+                    inflow[target[v]] += graph.getVertexWeight(v);
+                }
+            }
+            for (int_t t = 0_i; t < k; ++t) {
+                accepts_all[t] = (comp_weight[t] + inflow[t] <= max_allowed);
+            }
+            for (int_t v : active) {
+                const int_t t = target[v];
+                if (t != -1_i && independent[v] && accepts_all[t]) {
+                    const vw_t vertex_w = graph.getVertexWeight(v);
+                    comp_weight[partition[v]] -= vertex_w;
+                    comp_weight[t] += vertex_w;
+                    partition[v] = t;
                 }
             }
 
-            if (best_target != curr_comp) {
-                partition[v] = best_target;
-                comp_weight[curr_comp] -= vertex_w;
-                comp_weight[best_target] += vertex_w;
-				vertices_queue.push(v);
+            // 3. Remaining moves with recomputed gains, then the next active vertices
+            next_active.clear();
+            for (int_t v : active) {
+                const int_t t = target[v];
+                target[v] = -1_i;
+                if (t == -1_i) continue;
+
+                if (partition[v] != t) {
+                    const int_t curr_comp = partition[v];
+                    const vw_t vertex_w = graph.getVertexWeight(v);
+                    if (comp_weight[t] + vertex_w > max_allowed) {
+                        continue;
+                    }
+
+                    ew_t gain = c<ew_t>(0);
+                    for (auto [u, w] : graph[v]) {
+                        if (partition[u] == t) {
+                            gain += w;
+                        }
+                        else if (partition[u] == curr_comp) {
+                            gain -= w;
+                        }
+                    }
+                    if (gain <= c<ew_t>(0)) {
+                        continue;
+                    }
+
+                    comp_weight[curr_comp] -= vertex_w;
+                    comp_weight[t] += vertex_w;
+                    partition[v] = t;
+                }
+                ++moves_count;
+
+                if (round_mark[v] != round) {
+                    round_mark[v] = round;
+                    next_active.push_back(v);
+                }
+                for (auto [u, w] : graph[v]) {
+                    if (round_mark[u] != round) {
+                        round_mark[u] = round;
+                        next_active.push_back(u);
+                    }
+                }
             }
+
+            std::fill(inflow.begin(), inflow.end(), c<vw_t>(0));
+
+            active.swap(next_active);
         }
+
+		Instrumentation::Count("rounds", c<real_t>(rounds_count));
+		Instrumentation::Count("moves", c<real_t>(moves_count));
 	}
 };
\ No newline at end of file
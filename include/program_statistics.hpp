@@ -2,6 +2,7 @@
 
 #include <iostream>
 #include <algorithm>
+#include <mutex>
 
 #include "utils.hpp"
 #include "config.hpp"
@@ -17,6 +18,9 @@ struct ProgramStatistics {
 	inline static Vector<real_t> max_maximum;
 	inline static Vector<real_t> max_median;
 
+	// Recursive bisection may coarsen several subgraphs at once
+	inline static std::mutex statistics_mutex;
+
 
 	static void InitMatchingStatistics() {
 
@@ -35,6 +39,20 @@ struct ProgramStatistics {
 	template <typename vw_t>
 	static void UpdateMatchingStatistics(Vector<vw_t> weights, int_t level) {
 
+		std::lock_guard<std::mutex> lock(statistics_mutex);
+
+		// A job may coarsen deeper than ProgramConfig::coarsening_itarations_limit
+		if (level >= static_cast<int_t>(average.size())) {
+			average.resize(level + 1_i, 0.0_r);
+			maximum.resize(level + 1_i, 0.0_r);
+			median.resize(level + 1_i, 0.0_r);
+
+			denominator.resize(level + 1_i, 0.0_r);
+
+			max_maximum.resize(level + 1_i, 0.0_r);
+			max_median.resize(level + 1_i, 0.0_r);
+		}
+
 		const int_t n = weights.size();
 		const real_t total_w = static_cast<real_t>(std::accumulate(weights.begin(), weights.end(), c<vw_t>(0)));
 
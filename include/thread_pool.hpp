@@ -0,0 +1,139 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+#include "utils.hpp"
+
+// Work-stealing pool for fork-join parallelism.
+//
+// Every worker owns a deque of tasks: the owner pushes and pops at the back,
+// idle workers steal from the front of other deques. A thread waiting for a
+// forked task never blocks, it keeps executing pending tasks instead, so
+// nested ForkJoin calls (recursive bisection) cannot deadlock the pool.
+//
+// The calling thread takes part in the work, so a pool of `threads_count`
+// threads starts `threads_count - 1` background workers.
+//
+class ThreadPool {
+public:
+
+	using Task = std::function<void()>;
+
+private:
+
+	struct Worker {
+		std::deque<Task*> tasks;
+		std::mutex		  mutex;
+	};
+
+	Vector<std::unique_ptr<Worker>> workers;
+	Vector<std::thread>				threads;
+
+	std::atomic<int_t> pending_tasks = 0_i;
+	std::atomic<bool>  stopping = false;
+
+	std::mutex				sleep_mutex;
+	std::condition_variable sleep_cv;
+
+public:
+
+	explicit ThreadPool(int_t threads_count);
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	~ThreadPool();
+
+	// Returns a shared pool with the requested number of threads.
+	// One pool per thread count is kept for the lifetime of the process, so
+	// concurrent jobs with different counts do not replace each other's pool
+	// and repeated calls reuse the running threads.
+	static std::shared_ptr<ThreadPool> GetInstance(int_t threads_count);
+
+	int_t getThreadsCount() const noexcept {
+		return static_cast<int_t>(workers.size());
+	}
+
+	// Runs `left` and `right` potentially in parallel and returns when both are done.
+	// The first exception thrown by either of them is rethrown in the caller.
+	template <typename LeftTask, typename RightTask>
+	void ForkJoin(LeftTask&& left, RightTask&& right) {
+		if (workers.size() == 1) {
+			left();
+			right();
+			return;
+		}
+
+		std::atomic<bool> right_done = false;
+		std::exception_ptr right_error;
+
+		Task right_task = [&]() {
+			try {
+				right();
+			}
+			catch (...) {
+				right_error = std::current_exception();
+			}
+			right_done.store(true, std::memory_order_release);
+		};
+
+		push(&right_task);
+
+		std::exception_ptr left_error;
+		try {
+			left();
+		}
+		catch (...) {
+			left_error = std::current_exception();
+		}
+
+		while (!right_done.load(std::memory_order_acquire)) {
+			if (!tryRunTask()) {
+				std::this_thread::yield();
+			}
+		}
+
+		if (left_error) {
+			std::rethrow_exception(left_error);
+		}
+		if (right_error) {
+			std::rethrow_exception(right_error);
+		}
+	}
+
+	// Calls `body(i)` for every i in [begin, end). The range is split in halves
+	// through ForkJoin until it is not longer than `grain_size`.
+	template <typename Body>
+	void ParallelFor(int_t begin, int_t end, int_t grain_size, const Body& body) {
+		if (workers.size() == 1 || end - begin <= std::max(grain_size, 1_i)) {
+			for (int_t i = begin; i < end; ++i) {
+				body(i);
+			}
+			return;
+		}
+
+		const int_t middle = begin + (end - begin) / 2_i;
+		ForkJoin(
+			[&]() { ParallelFor(begin, middle, grain_size, body); },
+			[&]() { ParallelFor(middle, end, grain_size, body); }
+		);
+	}
+
+private:
+
+	void push(Task* task);
+
+	Task* pop(int_t worker_id);
+	Task* steal(int_t worker_id);
+
+	bool tryRunTask();
+
+	void workerLoop(int_t worker_id);
+};
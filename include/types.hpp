@@ -1,8 +1,14 @@
 #pragma once
 
+#include <cstdint>
+
 using int_t = long long;
 using real_t = double;
 
+// Default type of vertex ids stored in the adjacency of a graph.
+// Edge offsets (xadj) always use int_t.
+using vid_t = std::int32_t;
+
 constexpr real_t operator"" _r(long double x) {
     return static_cast<real_t>(x);
 }
@@ -8,90 +8,188 @@
 #include "graph.hpp"
 
 #include "coarse_level.hpp"
+#include "heap.hpp"
+#include "instrumentation.hpp"
+#include "bucket_queue.hpp"
+#include "workspace.hpp"
+
+// Uncoarsening method as a type, see the specializations after Uncoarser
+template <ProgramConfig::UncoarseningMethod method>
+struct RefinementStrategy;
 
 class Uncoarser {
 public:
 
-	template <typename vw_t, typename ew_t>
+	// `accuracy` is the allowed imbalance of the bipartition, used by the methods
+	// that control the balance themselves (FiducciaMattheyses).
+	// Every level is refined by `Refiner::Refine`, which is resolved at compile time.
+	template <typename Refiner, typename vw_t, typename ew_t, typename idx_t>
+	static void RestorePartition(
+		const Vector<CoarseLevel<vw_t, ew_t, idx_t>>& levels,
+			  Vector<int_t>&                   partition,
+		const real_t						   accuracy,
+		const PartitionerOptions&			   options
+	) {
+		Instrumentation::ScopedTimer timer("uncoarsening");
+
+		// The partition of the finer level is built in a second buffer,
+		// then the buffers are swapped
+		Workspace::Buffer<int_t> prev_partition_buffer;
+		Vector<int_t>& prev_partition = prev_partition_buffer.get();
+
+		for (int_t i = levels.size() - 1_i; i > 0_i; --i) {
+			Refiner::Refine(levels[i - 1_i], levels[i], partition, prev_partition, accuracy, options);
+			partition.swap(prev_partition);
+		}
+	}
+
+	// Uses the refinement of `options.uncoarsening_method`
+	template <typename vw_t, typename ew_t, typename idx_t>
+	static void RestorePartition(
+		const Vector<CoarseLevel<vw_t, ew_t, idx_t>>& levels,
+			  Vector<int_t>&                   partition,
+		const real_t						   accuracy,
+		const PartitionerOptions&			   options
+	) {
+		VisitRefinementStrategy(options.uncoarsening_method, [&]<typename Refiner>() {
+			RestorePartition<Refiner>(levels, partition, accuracy, options);
+		});
+	}
+
+	// Refines with the imbalance `options.accuracy`
+	template <typename vw_t, typename ew_t, typename idx_t>
 	static void RestorePartition(
-		const Vector<CoarseLevel<vw_t, ew_t>>& levels,
-			  Vector<int_t>&                   partition
+		const Vector<CoarseLevel<vw_t, ew_t, idx_t>>& levels,
+			  Vector<int_t>&                   partition,
+		const PartitionerOptions&			   options = PartitionerOptions()
 	) {
-		switch (ProgramConfig::uncoarsening_method) {
+		RestorePartition(levels, partition, options.accuracy, options);
+	}
+
+	// The only runtime dispatch on the uncoarsening method:
+	// returns `function.template operator()<RefinementStrategy<method>>()`
+	template <typename Function>
+	static decltype(auto) VisitRefinementStrategy(ProgramConfig::UncoarseningMethod method, Function&& function) {
+		switch (method) {
 		case ProgramConfig::UncoarseningMethod::DirectMapping:
-			for (int_t i = levels.size() - 1_i; i > 0_i; --i) {
-				partition = Uncoarser::DirectMapping<vw_t, ew_t>(levels[i - 1_i], levels[i], partition);
-			}
-			break;
+			return function.template operator()<RefinementStrategy<ProgramConfig::UncoarseningMethod::DirectMapping>>();
 		case ProgramConfig::UncoarseningMethod::KernighanLin:
-			for (int_t i = levels.size() - 1_i; i > 0_i; --i) {
-				partition = Uncoarser::KernighanLin<vw_t, ew_t>(levels[i - 1_i], levels[i], partition);
-			}
-			break;
+			return function.template operator()<RefinementStrategy<ProgramConfig::UncoarseningMethod::KernighanLin>>();
+		case ProgramConfig::UncoarseningMethod::FiducciaMattheyses:
+			return function.template operator()<RefinementStrategy<ProgramConfig::UncoarseningMethod::FiducciaMattheyses>>();
 
 		default:
-			throw std::runtime_error("Unknown uncoarsening method in ProgramConfig.");
+			throw std::runtime_error("Unknown uncoarsening method in PartitionerOptions.");
 		}
 	}
 
-	template <typename vw_t, typename ew_t>
-	static Vector<int_t> DirectMapping(
-		const CoarseLevel<vw_t, ew_t>& prev_level,
-		const CoarseLevel<vw_t, ew_t>& level,
-		const Vector<int_t>&		   coarse_partition
+	// Writes the projection of `coarse_partition` to the previous level into `prev_partition`
+	template <typename vw_t, typename ew_t, typename idx_t>
+	static void DirectMapping(
+		const CoarseLevel<vw_t, ew_t, idx_t>& prev_level,
+		const CoarseLevel<vw_t, ew_t, idx_t>& level,
+		const Vector<int_t>&		   coarse_partition,
+			  Vector<int_t>&		   prev_partition
 	) {
 		const int_t n = level.uncoarse_to_coarse.size();
-		Vector<int_t> prev_partition(n);
+		prev_partition.resize(n);
 
 		for (int_t i = 0_i; i < n; ++i) {
 			prev_partition[i] = coarse_partition[level.uncoarse_to_coarse[i]];
 		}
+	}
 
-		return prev_partition;
+	// Returns the vertices of the previous level that belong to coarse vertices
+	// with a neighbour in the other part. Only they can be on the cut after the
+	// projection, so refinement starts from them instead of scanning all vertices.
+	template <typename vw_t, typename ew_t, typename idx_t>
+	static void GetBoundaryCandidates(
+		const CoarseLevel<vw_t, ew_t, idx_t>& level,
+		const Vector<int_t>&		   coarse_partition,
+			  Vector<int_t>&		   candidates
+	) {
+		const Graph<vw_t, ew_t, idx_t>& coarse_graph = level.getGraph();
+
+		candidates.clear();
+
+		for (int_t coarse_V = 0_i; coarse_V < coarse_graph.getVerticesCount(); ++coarse_V) {
+			for (auto [next_V, w] : coarse_graph[coarse_V]) {
+				if (coarse_partition[next_V] != coarse_partition[coarse_V]) {
+					for (int_t i = level.coarse_to_uncoarse_xadj[coarse_V]; i < level.coarse_to_uncoarse_xadj[coarse_V + 1_i]; ++i) {
+						candidates.push_back(level.coarse_to_uncoarse[i]);
+					}
+					break;
+				}
+			}
+		}
 	}
 
-	template <typename vw_t, typename ew_t>
-	static Vector<int_t> KernighanLin(
-		const CoarseLevel<vw_t, ew_t>& prev_level,
-		const CoarseLevel<vw_t, ew_t>& level,
-		const Vector<int_t>& coarse_partition
+	// Part weights of a bipartition are the same on both levels,
+	// so they are computed on the smaller coarse graph
+	template <typename vw_t, typename ew_t, typename idx_t>
+	static void GetPartWeights(
+		const CoarseLevel<vw_t, ew_t, idx_t>& level,
+		const Vector<int_t>&		   coarse_partition,
+			  vw_t					   (&part_weight)[2]
 	) {
-		const int_t n = level.uncoarse_to_coarse.size();
+		const Graph<vw_t, ew_t, idx_t>& coarse_graph = level.getGraph();
 
-		Vector<int_t> prev_partition = DirectMapping<vw_t, ew_t>(prev_level, level, coarse_partition);
+		part_weight[0] = c<vw_t>(0);
+		part_weight[1] = c<vw_t>(0);
 
-		const Graph<vw_t, ew_t>& graph = prev_level.coarsed_graph;
+		for (int_t coarse_V = 0_i; coarse_V < coarse_graph.getVerticesCount(); ++coarse_V) {
+			part_weight[coarse_partition[coarse_V]] += coarse_graph.getVertexWeight(coarse_V);
+		}
+	}
 
-		Vector<bool> blocked(n, false);
+	template <typename vw_t, typename ew_t, typename idx_t>
+	static void KernighanLin(
+		const CoarseLevel<vw_t, ew_t, idx_t>& prev_level,
+		const CoarseLevel<vw_t, ew_t, idx_t>& level,
+		const Vector<int_t>& coarse_partition,
+			  Vector<int_t>& prev_partition,
+		const PartitionerOptions& options
+	) {
+		const int_t n = level.uncoarse_to_coarse.size();
 
-		if (ProgramConfig::uncoarsening_KernighanLin_use_blocking) {
+		DirectMapping<vw_t, ew_t>(prev_level, level, coarse_partition, prev_partition);
 
-			vw_t total_weight0 = c<vw_t>(0);
-			vw_t total_weight1 = c<vw_t>(0);
+		const Graph<vw_t, ew_t, idx_t>& graph = prev_level.getGraph();
 
-			for (int_t i = 0_i; i < n; ++i) {
-				if (prev_partition[i] == 0_i) {
-					total_weight0 += graph.getVertexWeight(i);
-				}
-				else {
-					total_weight1 += graph.getVertexWeight(i);
-				}
-			}
+		Workspace::Buffer<bool> blocked_buffer(n, false);
+		Vector<bool>& blocked = blocked_buffer.get();
+
+		if (options.uncoarsening_KernighanLin_use_blocking) {
+
+			vw_t total_weight[2];
+			GetPartWeights(level, coarse_partition, total_weight);
 
 			for (int_t i = 0; i < n; ++i) {
-				if (prev_partition[i] == 0_i && total_weight0 < total_weight1) {
+				if (prev_partition[i] == 0_i && total_weight[0] < total_weight[1]) {
 					blocked[i] = true;
 
 				}
-				if (prev_partition[i] == 1_i && total_weight1 < total_weight0) {
+				if (prev_partition[i] == 1_i && total_weight[1] < total_weight[0]) {
 					blocked[i] = true;
 				}
 			}
 		}
 
-		IndexedHeap<ew_t> heap(n);
+		Workspace::HeapBuffer<GainPriorityQueue<ew_t>> heap_buffer(n);
+		GainPriorityQueue<ew_t>& heap = heap_buffer.get();
 
+		// Only vertices on the cut and isolated vertices can have a non-positive
+		// priority; the others join the heap once a neighbour is moved
+		Workspace::Buffer<int_t> candidates_buffer;
+		Vector<int_t>& candidates = candidates_buffer.get();
+		GetBoundaryCandidates(level, coarse_partition, candidates);
 		for (int_t start_V = 0_i; start_V < n; ++start_V) {
+			if (graph.getDegree(start_V) == 0_i) {
+				candidates.push_back(start_V);
+			}
+		}
+
+		for (int_t start_V : candidates) {
 			ew_t inc_w = c<ew_t>(0);
 			ew_t dec_w = c<ew_t>(0);
 
@@ -106,9 +204,14 @@ public:
 				}
 			}
 
+			if (dec_w == c<ew_t>(0) && inc_w != c<ew_t>(0)) continue;
+
 			heap.push(inc_w - dec_w, start_V);
 		}
 
+		int_t moves_count = 0_i;
+		ew_t total_gain = c<ew_t>(0);
+
 		while (!heap.empty()) {
 			auto [priority, curr_V] = heap.extract();
 			blocked[curr_V] = true;
@@ -118,6 +221,8 @@ public:
 			}
 
 			prev_partition[curr_V] = 1_i - prev_partition[curr_V];
+			++moves_count;
+			total_gain -= priority;
 
 			for (auto [next_V, w1] : graph[curr_V]) {
 				if (!blocked[next_V]) {
@@ -136,6 +241,432 @@ public:
 			}
 		}
 
-		return prev_partition;
+		Instrumentation::Count("moves", c<real_t>(moves_count));
+		Instrumentation::Count("gain", c<real_t>(total_gain));
+	}
+
+	// Fiduccia-Mattheyses refinement of a bipartition.
+	//
+	// Every pass moves unlocked vertices one by one, taking the best gain from the
+	// side that can give a vertex without breaking the balance, including moves with
+	// negative gain. Each vertex moves at most once per pass. Afterwards the pass is
+	// rolled back to the prefix of moves with the smallest balanced edge cut.
+	//
+	// Only boundary vertices are queued. Cut and internal edge weights are computed
+	// lazily, when a vertex first becomes a boundary candidate, and then updated
+	// in O(deg) per move, so a level costs O(boundary * deg) instead of O(n * deg).
+	template <typename vw_t, typename ew_t, typename idx_t>
+	static void FiducciaMattheyses(
+		const CoarseLevel<vw_t, ew_t, idx_t>& prev_level,
+		const CoarseLevel<vw_t, ew_t, idx_t>& level,
+		const Vector<int_t>&		   coarse_partition,
+			  Vector<int_t>&		   partition,
+		const real_t				   accuracy,
+		const PartitionerOptions&	   options
+	) {
+		const int_t n = level.uncoarse_to_coarse.size();
+
+		DirectMapping<vw_t, ew_t>(prev_level, level, coarse_partition, partition);
+
+		const Graph<vw_t, ew_t, idx_t>& graph = prev_level.getGraph();
+
+		vw_t part_weight[2];
+		GetPartWeights(level, coarse_partition, part_weight);
+
+		const vw_t max_allowed = (accuracy + 1.0_r) * ((part_weight[0] + part_weight[1]) / c<vw_t>(2));
+
+		// Weights of cut and internal edges of every vertex, valid where `known` is set
+		Workspace::Buffer<ew_t> external_weight_buffer(n, c<ew_t>(0));
+		Workspace::Buffer<ew_t> internal_weight_buffer(n, c<ew_t>(0));
+		Workspace::Buffer<bool> known_buffer(n, false);
+
+		Vector<ew_t>& external_weight = external_weight_buffer.get();
+		Vector<ew_t>& internal_weight = internal_weight_buffer.get();
+		Vector<bool>& known = known_buffer.get();
+
+		auto ensure_known = [&](int_t curr_V) {
+			if (known[curr_V]) return;
+			known[curr_V] = true;
+			for (auto [next_V, w] : graph[curr_V]) {
+				if (partition[next_V] != partition[curr_V]) {
+					external_weight[curr_V] += w;
+				}
+				else {
+					internal_weight[curr_V] += w;
+				}
+			}
+		};
+
+		auto gain = [&](int_t curr_V) {
+			return external_weight[curr_V] - internal_weight[curr_V];
+		};
+
+		// Vertices with at least one cut edge
+		Workspace::Buffer<int_t> boundary_buffer;
+		Workspace::Buffer<int_t> boundary_position_buffer(n, -1_i);
+
+		Vector<int_t>& boundary = boundary_buffer.get();
+		Vector<int_t>& boundary_position = boundary_position_buffer.get();
+
+		auto refresh_boundary = [&](int_t curr_V) {
+			const bool on_cut = external_weight[curr_V] > c<ew_t>(0);
+			if (on_cut && boundary_position[curr_V] == -1_i) {
+				boundary_position[curr_V] = boundary.size();
+				boundary.push_back(curr_V);
+			}
+			else if (!on_cut && boundary_position[curr_V] != -1_i) {
+				const int_t last_V = boundary.back();
+				boundary[boundary_position[curr_V]] = last_V;
+				boundary_position[last_V] = boundary_position[curr_V];
+				boundary.pop_back();
+				boundary_position[curr_V] = -1_i;
+			}
+		};
+
+		{
+			Workspace::Buffer<int_t> candidates_buffer;
+			Vector<int_t>& candidates = candidates_buffer.get();
+			GetBoundaryCandidates(level, coarse_partition, candidates);
+
+			for (int_t curr_V : candidates) {
+				ensure_known(curr_V);
+				refresh_boundary(curr_V);
+			}
+		}
+
+		// Max-heaps of gains of the unlocked vertices of each part
+		using GainQueue = GainPriorityQueue<ew_t, std::greater<ew_t>>;
+		Workspace::HeapBuffer<GainQueue> queue_buffers[2] = {
+			Workspace::HeapBuffer<GainQueue>(n),
+			Workspace::HeapBuffer<GainQueue>(n)
+		};
+		GainQueue* queues[2] = { &queue_buffers[0].get(), &queue_buffers[1].get() };
+
+		Workspace::Buffer<bool> locked_buffer(n, false);
+		Workspace::Buffer<int_t> moves_buffer;
+
+		Vector<bool>& locked = locked_buffer.get();
+		Vector<int_t>& moves = moves_buffer.get();
+		bool rolling_back = false;
+
+		auto move = [&](int_t curr_V) {
+			const int_t from = partition[curr_V];
+
+			for (auto [next_V, w] : graph[curr_V]) {
+				ensure_known(next_V);
+			}
+
+			partition[curr_V] = 1_i - from;
+			part_weight[from] -= graph.getVertexWeight(curr_V);
+			part_weight[1_i - from] += graph.getVertexWeight(curr_V);
+
+			std::swap(external_weight[curr_V], internal_weight[curr_V]);
+			refresh_boundary(curr_V);
+
+			for (auto [next_V, w] : graph[curr_V]) {
+				if (partition[next_V] == from) {
+					external_weight[next_V] += w;
+					internal_weight[next_V] -= w;
+				}
+				else {
+					external_weight[next_V] -= w;
+					internal_weight[next_V] += w;
+				}
+				refresh_boundary(next_V);
+
+				GainQueue& queue = *queues[partition[next_V]];
+				if (!rolling_back && !locked[next_V] && (boundary_position[next_V] != -1_i || queue.contains(next_V))) {
+					queue.push(gain(next_V), next_V);
+				}
+			}
+		};
+
+		auto overweight = [&]() {
+			return std::max(part_weight[0], part_weight[1]) - max_allowed;
+		};
+
+		int_t moves_count = 0_i;
+		ew_t total_gain = c<ew_t>(0);
+
+		for (int_t pass = 0_i; pass < options.uncoarsening_FiducciaMattheyses_passes_count; ++pass) {
+			queues[0]->clear();
+			queues[1]->clear();
+			moves.clear();
+
+			for (int_t curr_V : boundary) {
+				queues[partition[curr_V]]->push(gain(curr_V), curr_V);
+			}
+
+			// Boundary vertices may be not enough to restore the balance
+			// (e.g. parts made of whole components), then the heavier part
+			// offers all its vertices
+			if (overweight() > c<vw_t>(0)) {
+				const int_t heavier = (part_weight[0] > part_weight[1]) ? 0_i : 1_i;
+				for (int_t curr_V = 0_i; curr_V < n; ++curr_V) {
+					if (partition[curr_V] == heavier && !queues[heavier]->contains(curr_V)) {
+						ensure_known(curr_V);
+						queues[heavier]->push(gain(curr_V), curr_V);
+					}
+				}
+			}
+
+			ew_t cut_delta = c<ew_t>(0);
+
+			int_t best_moves_count = 0_i;
+			ew_t best_cut_delta = c<ew_t>(0);
+			vw_t best_overweight = overweight();
+
+			while (static_cast<int_t>(moves.size()) - best_moves_count < options.uncoarsening_FiducciaMattheyses_moves_without_improvement_limit) {
+				// A part can give its best vertex if the other part stays within the limit,
+				// or if it is the heavier part and the move reduces the imbalance
+				int_t from = -1_i;
+				for (int_t side = 0_i; side < 2_i; ++side) {
+					if (queues[side]->empty()) continue;
+
+					const int_t curr_V = queues[side]->top().second;
+					const vw_t new_weight = part_weight[1_i - side] + graph.getVertexWeight(curr_V);
+
+					const bool feasible = new_weight <= max_allowed || new_weight < part_weight[side];
+					if (feasible && (from == -1_i || queues[side]->top().first > queues[from]->top().first)) {
+						from = side;
+					}
+				}
+
+				if (from == -1_i) {
+					break;
+				}
+
+				auto [curr_gain, curr_V] = queues[from]->extract();
+				locked[curr_V] = true;
+
+				move(curr_V);
+				moves.push_back(curr_V);
+				cut_delta -= curr_gain;
+
+				const vw_t curr_overweight = overweight();
+				const bool better = (curr_overweight <= c<vw_t>(0))
+					? (best_overweight > c<vw_t>(0) || cut_delta < best_cut_delta || (cut_delta == best_cut_delta && curr_overweight < best_overweight))
+					: (curr_overweight < best_overweight);
+
+				if (better) {
+					best_moves_count = moves.size();
+					best_cut_delta = cut_delta;
+					best_overweight = curr_overweight;
+				}
+			}
+
+			// Rollback to the best prefix
+			rolling_back = true;
+			for (int_t i = static_cast<int_t>(moves.size()) - 1_i; i >= best_moves_count; --i) {
+				move(moves[i]);
+			}
+			rolling_back = false;
+
+			for (int_t curr_V : moves) {
+				locked[curr_V] = false;
+			}
+
+			moves_count += best_moves_count;
+			total_gain -= best_cut_delta;
+
+			if (best_moves_count == 0_i) {
+				break;
+			}
+		}
+
+		Instrumentation::Count("moves", c<real_t>(moves_count));
+		Instrumentation::Count("gain", c<real_t>(total_gain));
+	}
+
+	// Projects a k-way partition from the coarsest level to the finest one,
+	// refining it on every level with KWayRefinement
+	template <typename vw_t, typename ew_t, typename idx_t>
+	static void RestoreKWayPartition(
+		const Vector<CoarseLevel<vw_t, ew_t, idx_t>>& levels,
+		const int_t							   k,
+			  Vector<int_t>&                   partition,
+		const real_t						   accuracy,
+		const PartitionerOptions&			   options
+	) {
+		Instrumentation::ScopedTimer timer("uncoarsening");
+
+		Workspace::Buffer<int_t> prev_partition_buffer;
+		Vector<int_t>& prev_partition = prev_partition_buffer.get();
+
+		for (int_t i = levels.size() - 1_i; i > 0_i; --i) {
+			Uncoarser::KWayRefinement<vw_t, ew_t>(levels[i - 1_i], levels[i], k, partition, prev_partition, accuracy, options);
+			partition.swap(prev_partition);
+		}
+	}
+
+	// Greedy k-way boundary refinement.
+	//
+	// Each pass visits the candidate vertices (initially the projected boundary)
+	// and moves a vertex to the adjacent part with the largest gain, if the move
+	// reduces the cut, or keeps it and improves the balance, or unloads an
+	// overweight part. Connectivity to all adjacent parts is collected in one
+	// adjacency scan. Neighbours of moved vertices become candidates of the next pass.
+	template <typename vw_t, typename ew_t, typename idx_t>
+	static void KWayRefinement(
+		const CoarseLevel<vw_t, ew_t, idx_t>& prev_level,
+		const CoarseLevel<vw_t, ew_t, idx_t>& level,
+		const int_t					   k,
+		const Vector<int_t>&		   coarse_partition,
+			  Vector<int_t>&		   partition,
+		const real_t				   accuracy,
+		const PartitionerOptions&	   options
+	) {
+		const int_t n = level.uncoarse_to_coarse.size();
+
+		DirectMapping<vw_t, ew_t>(prev_level, level, coarse_partition, partition);
+
+		const Graph<vw_t, ew_t, idx_t>& graph = prev_level.getGraph();
+		const Graph<vw_t, ew_t, idx_t>& coarse_graph = level.getGraph();
+
+		Workspace::Buffer<vw_t> part_weight_buffer(k, c<vw_t>(0));
+		Vector<vw_t>& part_weight = part_weight_buffer.get();
+		for (int_t coarse_V = 0_i; coarse_V < coarse_graph.getVerticesCount(); ++coarse_V) {
+			part_weight[coarse_partition[coarse_V]] += coarse_graph.getVertexWeight(coarse_V);
+		}
+
+		vw_t total_weight = c<vw_t>(0);
+		for (vw_t weight : part_weight) {
+			total_weight += weight;
+		}
+		const vw_t max_allowed = c<vw_t>(c<real_t>(total_weight) / c<real_t>(k) * (1.0_r + accuracy));
+
+		// Connectivity of the current vertex to every part
+		Workspace::Buffer<ew_t> connectivity_buffer(k, c<ew_t>(0));
+		Workspace::Buffer<int_t> adjacent_parts_buffer;
+
+		Vector<ew_t>& connectivity = connectivity_buffer.get();
+		Vector<int_t>& adjacent_parts = adjacent_parts_buffer.get();
+
+		// pass_mark[V] == pass means that V is already a candidate of that pass
+		Workspace::Buffer<int_t> pass_mark_buffer(n, -1_i);
+		Vector<int_t>& pass_mark = pass_mark_buffer.get();
+
+		Workspace::Buffer<int_t> candidates_buffer;
+		Workspace::Buffer<int_t> next_candidates_buffer;
+
+		Vector<int_t>& candidates = candidates_buffer.get();
+		Vector<int_t>& next_candidates = next_candidates_buffer.get();
+		GetBoundaryCandidates(level, coarse_partition, candidates);
+
+		int_t moves_count = 0_i;
+		ew_t total_gain = c<ew_t>(0);
+
+		for (int_t pass = 0_i; pass < options.uncoarsening_KWay_passes_count && !candidates.empty(); ++pass) {
+			next_candidates.clear();
+
+			for (int_t curr_V : candidates) {
+				const int_t from = partition[curr_V];
+				const vw_t vertex_W = graph.getVertexWeight(curr_V);
+
+				adjacent_parts.clear();
+				for (auto [next_V, w] : graph[curr_V]) {
+					const int_t part = partition[next_V];
+					if (connectivity[part] == c<ew_t>(0)) {
+						adjacent_parts.push_back(part);
+					}
+					connectivity[part] += w;
+				}
+
+				const ew_t internal_W = connectivity[from];
+
+				int_t best_to = -1_i;
+				ew_t best_gain = c<ew_t>(0);
+
+				for (int_t to : adjacent_parts) {
+					if (to == from || part_weight[to] + vertex_W > max_allowed) continue;
+
+					const ew_t gain = connectivity[to] - internal_W;
+					const bool balance_improves = part_weight[to] + vertex_W < part_weight[from];
+					const bool unloads = part_weight[from] > max_allowed;
+
+					if (gain > c<ew_t>(0) || (gain == c<ew_t>(0) && balance_improves) || unloads) {
+						if (best_to == -1_i || gain > best_gain || (gain == best_gain && part_weight[to] < part_weight[best_to])) {
+							best_to = to;
+							best_gain = gain;
+						}
+					}
+				}
+
+				for (int_t part : adjacent_parts) {
+					connectivity[part] = c<ew_t>(0);
+				}
+				connectivity[from] = c<ew_t>(0);
+
+				if (best_to == -1_i) {
+					continue;
+				}
+
+				partition[curr_V] = best_to;
+				part_weight[from] -= vertex_W;
+				part_weight[best_to] += vertex_W;
+
+				++moves_count;
+				total_gain += best_gain;
+
+				for (auto [next_V, w] : graph[curr_V]) {
+					if (pass_mark[next_V] != pass) {
+						pass_mark[next_V] = pass;
+						next_candidates.push_back(next_V);
+					}
+				}
+			}
+
+			candidates.swap(next_candidates);
+		}
+
+		Instrumentation::Count("moves", c<real_t>(moves_count));
+		Instrumentation::Count("gain", c<real_t>(total_gain));
+	}
+};
+
+// A refinement strategy projects the partition of `level` to `prev_level` and refines it with
+// Refine(prev_level, level, coarse_partition, prev_partition, accuracy, options)
+template <>
+struct RefinementStrategy<ProgramConfig::UncoarseningMethod::DirectMapping> {
+	template <typename vw_t, typename ew_t, typename idx_t>
+	static void Refine(
+		const CoarseLevel<vw_t, ew_t, idx_t>& prev_level,
+		const CoarseLevel<vw_t, ew_t, idx_t>& level,
+		const Vector<int_t>&		   coarse_partition,
+			  Vector<int_t>&		   prev_partition,
+		const real_t				   /* accuracy */,
+		const PartitionerOptions&	   /* options */
+	) {
+		Uncoarser::DirectMapping<vw_t, ew_t>(prev_level, level, coarse_partition, prev_partition);
+	}
+};
+
+template <>
+struct RefinementStrategy<ProgramConfig::UncoarseningMethod::KernighanLin> {
+	template <typename vw_t, typename ew_t, typename idx_t>
+	static void Refine(
+		const CoarseLevel<vw_t, ew_t, idx_t>& prev_level,
+		const CoarseLevel<vw_t, ew_t, idx_t>& level,
+		const Vector<int_t>&		   coarse_partition,
+			  Vector<int_t>&		   prev_partition,
+		const real_t				   /* accuracy */,
+		const PartitionerOptions&	   options
+	) {
+		Uncoarser::KernighanLin<vw_t, ew_t>(prev_level, level, coarse_partition, prev_partition, options);
+	}
+};
+
+template <>
+struct RefinementStrategy<ProgramConfig::UncoarseningMethod::FiducciaMattheyses> {
+	template <typename vw_t, typename ew_t, typename idx_t>
+	static void Refine(
+		const CoarseLevel<vw_t, ew_t, idx_t>& prev_level,
+		const CoarseLevel<vw_t, ew_t, idx_t>& level,
+		const Vector<int_t>&		   coarse_partition,
+			  Vector<int_t>&		   prev_partition,
+		const real_t				   accuracy,
+		const PartitionerOptions&	   options
+	) {
+		Uncoarser::FiducciaMattheyses<vw_t, ew_t>(prev_level, level, coarse_partition, prev_partition, accuracy, options);
 	}
 };
\ No newline at end of file
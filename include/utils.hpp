@@ -2,6 +2,8 @@
 
 #include <vector>
 #include <string>
+#include <random>
+#include <cstdint>
 #include <filesystem>
 
 #include "types.hpp"
@@ -33,7 +35,7 @@ Vector<String> GetFileNames(const String& folder, const String& format);
  * Generates a random permutation of integers in the range [0, n - 1].
  *
  * This function creates a sequence of integers from 0 to n - 1
- * and shuffles it using a random number generator based on std::mt19937.
+ * and shuffles it with the random stream of the calling thread.
  * 
  * Parameters:
  * - n - the size of the permutation				 | ex: 5
@@ -43,11 +45,21 @@ Vector<String> GetFileNames(const String& folder, const String& format);
  */
 Vector<int_t> GetRandomPermutation(int_t n);
 
+/*
+ * Same as above, but writes the permutation into an existing vector,
+ * so the buffer can be reused between calls.
+ *
+ * Parameters:
+ * - n - the size of the permutation				 | ex: 5
+ * - permutation - the output vector				 | ex: {4, 2, 3, 0, 1}
+ */
+void GetRandomPermutation(int_t n, Vector<int_t>& permutation);
+
 /*
  * Generates a random integer number from the range [0, n - 1].
  *
  * This function creates an integer from 0 to n - 1
- * using a random number generator based on std::mt19937.
+ * using the random stream of the calling thread.
  *
  * Parameters:
  * - n - the upper bound	   | ex: 5
@@ -55,4 +67,89 @@ Vector<int_t> GetRandomPermutation(int_t n);
  * Returns:
  * - int_t - generated number  | ex: 0
  */
-int_t GetRandomInt(int_t n);
\ No newline at end of file
+int_t GetRandomInt(int_t n);
+
+/*
+ * Mixes the bits of a 64-bit value (SplitMix64 finalizer).
+ *
+ * Used as a cheap stateless hash, e.g. to give every edge a pseudo-random
+ * priority that does not depend on the order of processing.
+ *
+ * Parameters:
+ * - x - the value to mix          | ex: 12
+ *
+ * Returns:
+ * - std::uint64_t - mixed value   | ex: 11479100032768123149
+ */
+constexpr std::uint64_t MixBits(std::uint64_t x) noexcept {
+	x += 0x9E3779B97F4A7C15ull;
+	x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+	x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+	return x ^ (x >> 31);
+}
+
+/*
+ * Derives the seed of the `index`-th child stream of a stream seeded with `seed`.
+ *
+ * Child seeds depend only on the parent seed and the index, so a task tree
+ * (recursion path, launch index) gets the same streams regardless of the
+ * order in which the tasks are executed.
+ *
+ * Parameters:
+ * - seed - the seed of the parent stream  | ex: 42
+ * - index - the index of the child        | ex: 1
+ *
+ * Returns:
+ * - std::uint64_t - seed of the child     | ex: 9297814886316923340
+ */
+constexpr std::uint64_t DeriveRandomSeed(std::uint64_t seed, std::uint64_t index) noexcept {
+	return MixBits(seed ^ MixBits(index + 0x632BE59BD9B4E019ull));
+}
+
+/*
+ * Sets the seed of the random stream of the calling thread.
+ *
+ * Every thread owns its own stream, so the functions above are safe
+ * to call concurrently. The stream is counter-based (SplitMix64): the i-th
+ * number is a hash of the seed and i, and the numbers, permutations and
+ * derived seeds it gives are the same on every platform. A thread that was
+ * never seeded explicitly draws its initial seed from std::random_device.
+ *
+ * Parameters:
+ * - seed - the new seed of the stream  | ex: 42
+ */
+void SetRandomSeed(std::uint64_t seed);
+
+/*
+ * Draws a seed for child tasks from the stream of the calling thread.
+ * The seeds of the children themselves are DeriveRandomSeed(seed, index).
+ *
+ * Parameters:
+ * - (none)
+ *
+ * Returns:
+ * - std::uint64_t - generated seed  | ex: 3510924417
+ */
+std::uint64_t GetRandomSeed();
+
+// State of the random stream of a thread
+struct RandomStreamState {
+	std::uint64_t seed = 0;
+	std::uint64_t counter = 0;
+};
+
+// Reseeds the stream of the calling thread for the lifetime of the object
+// and restores its previous state on destruction. Used to give every parallel
+// task its own random stream, independent of the thread that executes it.
+class ScopedRandomSeed {
+private:
+	RandomStreamState saved_state;
+
+public:
+	explicit ScopedRandomSeed(std::uint64_t seed);
+
+	ScopedRandomSeed(const ScopedRandomSeed&) = delete;
+	ScopedRandomSeed& operator=(const ScopedRandomSeed&) = delete;
+
+	~ScopedRandomSeed();
+};
\ No newline at end of file
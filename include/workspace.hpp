@@ -0,0 +1,160 @@
+#pragma once
+
+#include <memory>
+#include <utility>
+
+#include "utils.hpp"
+
+// Per-thread pool of scratch memory for the multilevel pipeline.
+//
+// Every level of every bisection needs several O(n) temporary arrays and heaps.
+// Instead of allocating them, the phases borrow them from the pool of the
+// current thread; a borrowed object goes back to the pool when its buffer is
+// destroyed and keeps its capacity, so the next level, launch or bisection
+// reuses the memory. After the first bisection of the largest graph the
+// pipeline works almost without heap allocations.
+//
+// Every thread has its own pool, so no locking is needed. A buffer is
+// returned to the pool of the thread that destroys it.
+//
+// Usage:
+//   Workspace::Buffer<int_t> matching_buffer(n, -1_i);
+//   Vector<int_t>& matching = matching_buffer.get();
+//
+class Workspace {
+public:
+
+	// Vector borrowed from the pool
+	template <typename T>
+	class Buffer {
+	private:
+
+		Vector<T> data;
+		bool	  owns = true;
+
+	public:
+
+		// Empty vector, it keeps the capacity of the previous user
+		Buffer() : data(acquire<T>()) {}
+
+		Buffer(int_t size, const T& value) : Buffer() {
+			data.assign(size, value);
+		}
+
+		Buffer(const Buffer&) = delete;
+		Buffer& operator=(const Buffer&) = delete;
+
+		Buffer(Buffer&& other) noexcept : data(std::move(other.data)), owns(other.owns) {
+			other.owns = false;
+		}
+
+		Buffer& operator=(Buffer&&) = delete;
+
+		~Buffer() {
+			if (owns) {
+				release(std::move(data));
+			}
+		}
+
+		Vector<T>& get() noexcept {
+			return data;
+		}
+
+		const Vector<T>& get() const noexcept {
+			return data;
+		}
+	};
+
+	// Empty heap with at least the requested capacity, borrowed from the pool.
+	// `Heap` must provide getCapacity() and clear(); a heap with reserve()
+	// is grown in place instead of being reallocated.
+	template <typename Heap>
+	class HeapBuffer {
+	private:
+
+		std::unique_ptr<Heap> heap;
+
+	public:
+
+		explicit HeapBuffer(int_t capacity) : heap(acquireHeap<Heap>(capacity)) {}
+
+		HeapBuffer(const HeapBuffer&) = delete;
+		HeapBuffer& operator=(const HeapBuffer&) = delete;
+
+		HeapBuffer(HeapBuffer&& other) noexcept = default;
+		HeapBuffer& operator=(HeapBuffer&&) = delete;
+
+		~HeapBuffer() {
+			if (heap) {
+				releaseHeap(std::move(heap));
+			}
+		}
+
+		Heap& get() noexcept {
+			return *heap;
+		}
+	};
+
+private:
+
+	template <typename T>
+	static Vector<Vector<T>>& getPool() {
+		thread_local Vector<Vector<T>> pool;
+		return pool;
+	}
+
+	template <typename Heap>
+	static Vector<std::unique_ptr<Heap>>& getHeapPool() {
+		thread_local Vector<std::unique_ptr<Heap>> pool;
+		return pool;
+	}
+
+	template <typename T>
+	static Vector<T> acquire() {
+		Vector<Vector<T>>& pool = getPool<T>();
+		if (pool.empty()) {
+			return Vector<T>();
+		}
+		Vector<T> data = std::move(pool.back());
+		pool.pop_back();
+		data.clear();
+		return data;
+	}
+
+	template <typename T>
+	static void release(Vector<T>&& data) {
+		if (data.capacity() > 0) {
+			getPool<T>().push_back(std::move(data));
+		}
+	}
+
+	// The most recently released heap that is large enough is taken
+	template <typename Heap>
+	static std::unique_ptr<Heap> acquireHeap(int_t capacity) {
+		Vector<std::unique_ptr<Heap>>& pool = getHeapPool<Heap>();
+		for (int_t i = static_cast<int_t>(pool.size()) - 1_i; i >= 0_i; --i) {
+			if (pool[i]->getCapacity() >= capacity) {
+				std::unique_ptr<Heap> heap = std::move(pool[i]);
+				pool.erase(pool.begin() + i);
+				return heap;
+			}
+		}
+		// The graphs became larger, a smaller heap will not be needed again
+		if (!pool.empty()) {
+			if constexpr (requires(Heap& heap) { heap.reserve(capacity); }) {
+				std::unique_ptr<Heap> heap = std::move(pool.back());
+				pool.pop_back();
+				heap->reserve(capacity);
+				return heap;
+			}
+			pool.pop_back();
+		}
+		return std::make_unique<Heap>(capacity);
+	}
+
+	template <typename Heap>
+	static void releaseHeap(std::unique_ptr<Heap>&& heap) {
+		heap->clear();
+		getHeapPool<Heap>().push_back(std::move(heap));
+	}
+};
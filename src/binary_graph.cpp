@@ -0,0 +1,123 @@
+#include <cstring>
+#include <stdexcept>
+
+#ifdef _WIN32
+	#ifndef NOMINMAX
+		#define NOMINMAX
+	#endif
+	#include <windows.h>
+#else
+	#include <fcntl.h>
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <unistd.h>
+#endif
+
+#include "binary_graph.hpp"
+
+std::uint64_t GetChecksum(const void* data, std::size_t size, std::uint64_t hash) {
+	const unsigned char* bytes = static_cast<const unsigned char*>(data);
+
+	std::size_t i = 0;
+	for (; i + 8 <= size; i += 8) {
+		std::uint64_t word;
+		std::memcpy(&word, bytes + i, 8);
+		hash = MixBits(hash ^ word);
+	}
+
+	if (i < size) {
+		std::uint64_t word = 0;
+		std::memcpy(&word, bytes + i, size - i);
+		hash = MixBits(hash ^ word);
+	}
+
+	return hash;
+}
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const String& file_name) {
+	HANDLE file = CreateFileA(file_name.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE) {
+		throw std::runtime_error("Can't open file " + file_name);
+	}
+	file_handle = file;
+
+	LARGE_INTEGER file_size;
+	if (!GetFileSizeEx(file, &file_size)) {
+		CloseHandle(file);
+		throw std::runtime_error("Can't get size of file " + file_name);
+	}
+	mapped_size = static_cast<std::size_t>(file_size.QuadPart);
+
+	if (mapped_size == 0) {
+		return;
+	}
+
+	HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (mapping == nullptr) {
+		CloseHandle(file);
+		throw std::runtime_error("Can't map file " + file_name);
+	}
+	mapping_handle = mapping;
+
+	mapped_data = static_cast<const std::byte*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+	if (mapped_data == nullptr) {
+		CloseHandle(mapping);
+		CloseHandle(file);
+		throw std::runtime_error("Can't map file " + file_name);
+	}
+}
+
+MappedFile::~MappedFile() {
+	if (mapped_data != nullptr) {
+		UnmapViewOfFile(mapped_data);
+	}
+	if (mapping_handle != nullptr) {
+		CloseHandle(static_cast<HANDLE>(mapping_handle));
+	}
+	if (file_handle != nullptr) {
+		CloseHandle(static_cast<HANDLE>(file_handle));
+	}
+}
+
+#else
+
+MappedFile::MappedFile(const String& file_name) {
+	int file = open(file_name.c_str(), O_RDONLY);
+	if (file == -1) {
+		throw std::runtime_error("Can't open file " + file_name);
+	}
+
+	struct stat file_stat;
+	if (fstat(file, &file_stat) == -1) {
+		close(file);
+		throw std::runtime_error("Can't get size of file " + file_name);
+	}
+	mapped_size = static_cast<std::size_t>(file_stat.st_size);
+
+	if (mapped_size == 0) {
+		close(file);
+		return;
+	}
+
+	void* mapping = mmap(nullptr, mapped_size, PROT_READ, MAP_PRIVATE, file, 0);
+	close(file);
+
+	if (mapping == MAP_FAILED) {
+		throw std::runtime_error("Can't map file " + file_name);
+	}
+
+	// The whole file is read once, front to back
+	madvise(mapping, mapped_size, MADV_SEQUENTIAL);
+
+	mapped_data = static_cast<const std::byte*>(mapping);
+}
+
+MappedFile::~MappedFile() {
+	if (mapped_data != nullptr) {
+		munmap(const_cast<std::byte*>(mapped_data), mapped_size);
+	}
+}
+
+#endif
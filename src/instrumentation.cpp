@@ -0,0 +1,210 @@
+#include <iomanip>
+
+#include "instrumentation.hpp"
+
+// Report of the last finished session
+static std::mutex last_report_mutex;
+static Instrumentation::Report last_report;
+
+Instrumentation::Node* Instrumentation::Node::getChild(const String& child_name) {
+	std::lock_guard<std::mutex> lock(mutex);
+	for (const std::unique_ptr<Node>& child : children) {
+		if (child->name == child_name) {
+			return child.get();
+		}
+	}
+	children.push_back(std::make_unique<Node>());
+	children.back()->name = child_name;
+	return children.back().get();
+}
+
+void Instrumentation::Node::add(const String& value_name, real_t value, bool is_sample) {
+	std::lock_guard<std::mutex> lock(mutex);
+
+	Statistic* statistic = nullptr;
+	for (auto& [name, curr_statistic] : values) {
+		if (name == value_name) {
+			statistic = &curr_statistic;
+			break;
+		}
+	}
+	if (statistic == nullptr) {
+		values.emplace_back(value_name, Statistic());
+		statistic = &values.back().second;
+		statistic->is_sample = is_sample;
+		statistic->min = value;
+		statistic->max = value;
+	}
+
+	statistic->sum += value;
+	statistic->min = std::min(statistic->min, value);
+	statistic->max = std::max(statistic->max, value);
+	++statistic->count;
+}
+
+void Instrumentation::Node::addTime(real_t elapsed_ms) {
+	std::lock_guard<std::mutex> lock(mutex);
+	time_ms += elapsed_ms;
+	++calls;
+}
+
+const Instrumentation::Node* Instrumentation::Node::findChild(const String& child_name) const {
+	std::lock_guard<std::mutex> lock(mutex);
+	for (const std::unique_ptr<Node>& child : children) {
+		if (child->name == child_name) {
+			return child.get();
+		}
+	}
+	return nullptr;
+}
+
+const Instrumentation::Statistic* Instrumentation::Node::findValue(const String& value_name) const {
+	std::lock_guard<std::mutex> lock(mutex);
+	for (const auto& [name, statistic] : values) {
+		if (name == value_name) {
+			return &statistic;
+		}
+	}
+	return nullptr;
+}
+
+Instrumentation::Report Instrumentation::GetLastReport() {
+	std::lock_guard<std::mutex> lock(last_report_mutex);
+	return last_report;
+}
+
+static void PrintNode(std::ostream& out, const Instrumentation::Node& node, int_t depth) {
+	out << String(2_i * depth, ' ') << node.name << ": " << std::fixed << std::setprecision(3) << node.time_ms << " ms";
+	if (node.calls != 1_i) {
+		out << ", " << node.calls << " calls";
+	}
+
+	bool first = true;
+	for (const auto& [name, statistic] : node.values) {
+		out << (first ? " | " : ", ") << name << " = " << std::defaultfloat << std::setprecision(6);
+		if (statistic.is_sample) {
+			out << statistic.getMean() << " (" << statistic.min << " .. " << statistic.max << ")";
+		}
+		else {
+			out << statistic.sum;
+		}
+		first = false;
+	}
+	out << "\n";
+
+	for (const std::unique_ptr<Instrumentation::Node>& child : node.children) {
+		PrintNode(out, *child, depth + 1_i);
+	}
+}
+
+void Instrumentation::PrintReport(std::ostream& out, const Node& report) {
+	PrintNode(out, report, 0_i);
+}
+
+static void PrintNodeJSON(std::ostream& out, const Instrumentation::Node& node) {
+	out << "{\"name\": \"" << node.name << "\", \"calls\": " << node.calls
+		<< ", \"time_ms\": " << std::setprecision(9) << node.time_ms << ", \"values\": {";
+
+	for (int_t i = 0_i; i < static_cast<int_t>(node.values.size()); ++i) {
+		const auto& [name, statistic] = node.values[i];
+		out << (i > 0_i ? ", " : "") << "\"" << name << "\": ";
+		if (statistic.is_sample) {
+			out << "{\"mean\": " << statistic.getMean() << ", \"min\": " << statistic.min
+				<< ", \"max\": " << statistic.max << ", \"count\": " << statistic.count << "}";
+		}
+		else {
+			out << statistic.sum;
+		}
+	}
+
+	out << "}, \"children\": [";
+	for (int_t i = 0_i; i < static_cast<int_t>(node.children.size()); ++i) {
+		out << (i > 0_i ? ", " : "");
+		PrintNodeJSON(out, *node.children[i]);
+	}
+	out << "]}";
+}
+
+void Instrumentation::PrintReportJSON(std::ostream& out, const Node& report) {
+	PrintNodeJSON(out, report);
+	out << "\n";
+}
+
+#ifdef YAGKP_INSTRUMENTATION
+
+Instrumentation::Node*& Instrumentation::getCurrentNode() noexcept {
+	thread_local Node* current_node = nullptr;
+	return current_node;
+}
+
+Instrumentation::ScopedTimer::ScopedTimer(const char* name) {
+	if (getCurrentNode() != nullptr) {
+		enter(name);
+	}
+}
+
+Instrumentation::ScopedTimer::ScopedTimer(const char* name, int_t index) {
+	if (getCurrentNode() != nullptr) {
+		enter(String(name) + " " + std::to_string(index));
+	}
+}
+
+void Instrumentation::ScopedTimer::enter(const String& name) {
+	parent = getCurrentNode();
+	node = parent->getChild(name);
+	getCurrentNode() = node;
+	start = std::chrono::steady_clock::now();
+}
+
+Instrumentation::ScopedTimer::~ScopedTimer() {
+	if (node == nullptr) {
+		return;
+	}
+	const auto finish = std::chrono::steady_clock::now();
+	node->addTime(std::chrono::duration<real_t, std::milli>(finish - start).count());
+	getCurrentNode() = parent;
+}
+
+Instrumentation::ScopedContext::ScopedContext(Context context) :
+	saved_node(getCurrentNode())
+{
+	getCurrentNode() = context;
+}
+
+Instrumentation::ScopedContext::~ScopedContext() {
+	getCurrentNode() = saved_node;
+}
+
+Instrumentation::Session::Session(const char* name, bool enabled, Report* report_output) :
+	output(report_output)
+{
+	if (getCurrentNode() != nullptr) {
+		nested.emplace(name);
+		return;
+	}
+	if (!enabled) {
+		return;
+	}
+	root = std::make_shared<Node>();
+	root->name = name;
+	getCurrentNode() = root.get();
+	start = std::chrono::steady_clock::now();
+}
+
+Instrumentation::Session::~Session() {
+	if (!root) {
+		return;
+	}
+	const auto finish = std::chrono::steady_clock::now();
+	root->addTime(std::chrono::duration<real_t, std::milli>(finish - start).count());
+	getCurrentNode() = nullptr;
+
+	if (output != nullptr) {
+		*output = root;
+	}
+
+	std::lock_guard<std::mutex> lock(last_report_mutex);
+	last_report = std::move(root);
+}
+
+#endif
@@ -0,0 +1,304 @@
+#include "padded_adjacency.hpp"
+
+// Kernels of the other instruction sets are compiled with target attributes
+// and chosen at runtime, so the library runs on any x86-64 processor.
+// Other compilers build them only if the whole build targets the set.
+#if (defined(__GNUC__) || defined(__clang__)) && (defined(__x86_64__) || defined(__i386__))
+	#define YAGKP_KERNEL_TARGET(set) __attribute__((target(set)))
+	#define YAGKP_RUNTIME_DETECTION
+	#define YAGKP_AVX2_KERNELS
+	#define YAGKP_AVX512_KERNELS
+#else
+	#define YAGKP_KERNEL_TARGET(set)
+	#ifdef __AVX2__
+		#define YAGKP_AVX2_KERNELS
+	#endif
+	#ifdef __AVX512F__
+		#define YAGKP_AVX512_KERNELS
+	#endif
+#endif
+
+#if defined(YAGKP_AVX2_KERNELS) || defined(YAGKP_AVX512_KERNELS)
+	#include <immintrin.h>
+#endif
+
+using InstructionSet = ProgramConfig::InstructionSet;
+
+static constexpr real_t MINUS_INFINITY = -std::numeric_limits<real_t>::infinity();
+
+// --- Scalar ---
+
+static int_t FindScalar(const std::int32_t* ids, const real_t* ratings, int_t count, const int_t* weights, int_t limit) {
+	int_t best = -1_i;
+	real_t best_rating = MINUS_INFINITY;
+	for (int_t i = 0_i; i < count; ++i) {
+		if (ratings[i] > best_rating && weights[ids[i]] <= limit) {
+			best = i;
+			best_rating = ratings[i];
+		}
+	}
+	return best;
+}
+
+static int_t FindScalar(const std::int32_t* ids, const real_t* ratings, int_t count, const real_t* weights, real_t own_weight, real_t limit) {
+	int_t best = -1_i;
+	real_t best_rating = MINUS_INFINITY;
+	for (int_t i = 0_i; i < count; ++i) {
+		if (ratings[i] > best_rating && !(own_weight + weights[ids[i]] > limit)) {
+			best = i;
+			best_rating = ratings[i];
+		}
+	}
+	return best;
+}
+
+// --- AVX2 ---
+//
+// Every lane keeps the first position of its maximum, so the reduction takes
+// the smallest position among the lanes with the largest rating. Weights are
+// gathered only for the lanes with a rating above the current maxima, the
+// other lanes get a zero from the masked gather.
+
+#ifdef YAGKP_AVX2_KERNELS
+
+// Maximum of all lanes in every lane
+YAGKP_KERNEL_TARGET("avx2")
+static __m256d BroadcastMaxAVX2(__m256d values) {
+	values = _mm256_max_pd(values, _mm256_permute2f128_pd(values, values, 1));
+	return _mm256_max_pd(values, _mm256_permute_pd(values, 5));
+}
+
+YAGKP_KERNEL_TARGET("avx2")
+static int_t ReduceAVX2(__m256d best_ratings, __m256d best_positions) {
+	const __m256d best_rating = BroadcastMaxAVX2(best_ratings);
+	if (_mm256_cvtsd_f64(best_rating) == MINUS_INFINITY) {
+		return -1_i;
+	}
+
+	// Positions are compared negated, so the maximum gives the smallest one
+	const __m256d best_lanes = _mm256_cmp_pd(best_ratings, best_rating, _CMP_EQ_OQ);
+	const __m256d negated_positions = _mm256_blendv_pd(_mm256_set1_pd(MINUS_INFINITY), _mm256_sub_pd(_mm256_setzero_pd(), best_positions), best_lanes);
+	return static_cast<int_t>(-_mm256_cvtsd_f64(BroadcastMaxAVX2(negated_positions)));
+}
+
+YAGKP_KERNEL_TARGET("avx2")
+static int_t FindAVX2(const std::int32_t* ids, const real_t* ratings, int_t count, const int_t* weights, int_t limit) {
+	const __m256i limit_v = _mm256_set1_epi64x(limit);
+
+	__m256d best_ratings = _mm256_set1_pd(MINUS_INFINITY);
+	__m256d best_positions = _mm256_set1_pd(-1.0);
+
+	for (int_t i = 0_i; i < count; i += 4_i) {
+		const __m256d curr_ratings = _mm256_loadu_pd(ratings + i);
+		__m256d better = _mm256_cmp_pd(curr_ratings, best_ratings, _CMP_GT_OQ);
+		if (_mm256_movemask_pd(better) == 0) continue;
+
+		const __m128i curr_ids = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ids + i));
+		const __m256i curr_weights = _mm256_mask_i32gather_epi64(_mm256_setzero_si256(), reinterpret_cast<const long long*>(weights), curr_ids, _mm256_castpd_si256(better), 8);
+		better = _mm256_andnot_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(curr_weights, limit_v)), better);
+
+		const __m256d positions = _mm256_add_pd(_mm256_set1_pd(static_cast<real_t>(i)), _mm256_setr_pd(0.0, 1.0, 2.0, 3.0));
+		best_ratings = _mm256_blendv_pd(best_ratings, curr_ratings, better);
+		best_positions = _mm256_blendv_pd(best_positions, positions, better);
+	}
+
+	return ReduceAVX2(best_ratings, best_positions);
+}
+
+YAGKP_KERNEL_TARGET("avx2")
+static int_t FindAVX2(const std::int32_t* ids, const real_t* ratings, int_t count, const real_t* weights, real_t own_weight, real_t limit) {
+	const __m256d own_weight_v = _mm256_set1_pd(own_weight);
+	const __m256d limit_v = _mm256_set1_pd(limit);
+
+	__m256d best_ratings = _mm256_set1_pd(MINUS_INFINITY);
+	__m256d best_positions = _mm256_set1_pd(-1.0);
+
+	for (int_t i = 0_i; i < count; i += 4_i) {
+		const __m256d curr_ratings = _mm256_loadu_pd(ratings + i);
+		__m256d better = _mm256_cmp_pd(curr_ratings, best_ratings, _CMP_GT_OQ);
+		if (_mm256_movemask_pd(better) == 0) continue;
+
+		const __m128i curr_ids = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ids + i));
+		const __m256d total_weights = _mm256_add_pd(own_weight_v, _mm256_mask_i32gather_pd(_mm256_setzero_pd(), weights, curr_ids, better, 8));
+		better = _mm256_andnot_pd(_mm256_cmp_pd(total_weights, limit_v, _CMP_GT_OQ), better);
+
+		const __m256d positions = _mm256_add_pd(_mm256_set1_pd(static_cast<real_t>(i)), _mm256_setr_pd(0.0, 1.0, 2.0, 3.0));
+		best_ratings = _mm256_blendv_pd(best_ratings, curr_ratings, better);
+		best_positions = _mm256_blendv_pd(best_positions, positions, better);
+	}
+
+	return ReduceAVX2(best_ratings, best_positions);
+}
+
+#endif
+
+// --- AVX-512 ---
+
+#ifdef YAGKP_AVX512_KERNELS
+
+// The unmasked forms of these intrinsics pass an undefined source register,
+// which GCC reports under -Wall, so the masked forms with all lanes set and an
+// explicit source are used instead
+static constexpr __mmask8 ALL_LANES = 0xFF;
+
+// Maximum of all lanes in every lane
+YAGKP_KERNEL_TARGET("avx512f")
+static __m512d BroadcastMaxAVX512(__m512d values) {
+	values = _mm512_mask_max_pd(values, ALL_LANES, values, _mm512_mask_shuffle_f64x2(values, ALL_LANES, values, values, 0x4E));
+	values = _mm512_mask_max_pd(values, ALL_LANES, values, _mm512_mask_shuffle_f64x2(values, ALL_LANES, values, values, 0xB1));
+	return _mm512_mask_max_pd(values, ALL_LANES, values, _mm512_mask_permute_pd(values, ALL_LANES, values, 0x55));
+}
+
+YAGKP_KERNEL_TARGET("avx512f")
+static int_t ReduceAVX512(__m512d best_ratings, __m512d best_positions) {
+	const __m512d best_rating = BroadcastMaxAVX512(best_ratings);
+	if (_mm512_cvtsd_f64(best_rating) == MINUS_INFINITY) {
+		return -1_i;
+	}
+
+	// Positions are compared negated, so the maximum gives the smallest one
+	const __mmask8 best_lanes = _mm512_cmp_pd_mask(best_ratings, best_rating, _CMP_EQ_OQ);
+	const __m512d negated_positions = _mm512_mask_sub_pd(_mm512_set1_pd(MINUS_INFINITY), best_lanes, _mm512_setzero_pd(), best_positions);
+	return static_cast<int_t>(-_mm512_cvtsd_f64(BroadcastMaxAVX512(negated_positions)));
+}
+
+YAGKP_KERNEL_TARGET("avx512f")
+static int_t FindAVX512(const std::int32_t* ids, const real_t* ratings, int_t count, const int_t* weights, int_t limit) {
+	const __m512i limit_v = _mm512_set1_epi64(limit);
+	const __m512d lanes = _mm512_set_pd(7.0, 6.0, 5.0, 4.0, 3.0, 2.0, 1.0, 0.0);
+
+	__m512d best_ratings = _mm512_set1_pd(MINUS_INFINITY);
+	__m512d best_positions = _mm512_set1_pd(-1.0);
+
+	for (int_t i = 0_i; i < count; i += 8_i) {
+		const __m512d curr_ratings = _mm512_loadu_pd(ratings + i);
+		__mmask8 better = _mm512_cmp_pd_mask(curr_ratings, best_ratings, _CMP_GT_OQ);
+		if (better == 0) continue;
+
+		const __m256i curr_ids = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ids + i));
+		const __m512i curr_weights = _mm512_mask_i32gather_epi64(_mm512_setzero_si512(), better, curr_ids, weights, 8);
+		better = _mm512_mask_cmple_epi64_mask(better, curr_weights, limit_v);
+
+		const __m512d positions = _mm512_add_pd(_mm512_set1_pd(static_cast<real_t>(i)), lanes);
+		best_ratings = _mm512_mask_blend_pd(better, best_ratings, curr_ratings);
+		best_positions = _mm512_mask_blend_pd(better, best_positions, positions);
+	}
+
+	return ReduceAVX512(best_ratings, best_positions);
+}
+
+YAGKP_KERNEL_TARGET("avx512f")
+static int_t FindAVX512(const std::int32_t* ids, const real_t* ratings, int_t count, const real_t* weights, real_t own_weight, real_t limit) {
+	const __m512d own_weight_v = _mm512_set1_pd(own_weight);
+	const __m512d limit_v = _mm512_set1_pd(limit);
+	const __m512d lanes = _mm512_set_pd(7.0, 6.0, 5.0, 4.0, 3.0, 2.0, 1.0, 0.0);
+
+	__m512d best_ratings = _mm512_set1_pd(MINUS_INFINITY);
+	__m512d best_positions = _mm512_set1_pd(-1.0);
+
+	for (int_t i = 0_i; i < count; i += 8_i) {
+		const __m512d curr_ratings = _mm512_loadu_pd(ratings + i);
+		__mmask8 better = _mm512_cmp_pd_mask(curr_ratings, best_ratings, _CMP_GT_OQ);
+		if (better == 0) continue;
+
+		const __m256i curr_ids = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(ids + i));
+		const __m512d total_weights = _mm512_add_pd(own_weight_v, _mm512_mask_i32gather_pd(_mm512_setzero_pd(), better, curr_ids, weights, 8));
+		better = _mm512_mask_cmp_pd_mask(better, total_weights, limit_v, _CMP_NGT_UQ);
+
+		const __m512d positions = _mm512_add_pd(_mm512_set1_pd(static_cast<real_t>(i)), lanes);
+		best_ratings = _mm512_mask_blend_pd(better, best_ratings, curr_ratings);
+		best_positions = _mm512_mask_blend_pd(better, best_positions, positions);
+	}
+
+	return ReduceAVX512(best_ratings, best_positions);
+}
+
+#endif
+
+// --- Dispatch ---
+
+static InstructionSet DetectSupported() {
+#if defined(YAGKP_AVX512_KERNELS)
+	#ifdef YAGKP_RUNTIME_DETECTION
+	if (__builtin_cpu_supports("avx512f")) {
+		return InstructionSet::AVX512;
+	}
+	#else
+	return InstructionSet::AVX512;
+	#endif
+#endif
+#if defined(YAGKP_AVX2_KERNELS)
+	#ifdef YAGKP_RUNTIME_DETECTION
+	if (__builtin_cpu_supports("avx2")) {
+		return InstructionSet::AVX2;
+	}
+	#else
+	return InstructionSet::AVX2;
+	#endif
+#endif
+	return InstructionSet::Scalar;
+}
+
+InstructionSet MaskedArgMax::GetSupported() {
+	static const InstructionSet supported = DetectSupported();
+	return supported;
+}
+
+InstructionSet MaskedArgMax::Resolve(InstructionSet requested) {
+	const InstructionSet supported = GetSupported();
+	if (requested == InstructionSet::Best) {
+		return supported;
+	}
+	return (static_cast<int>(requested) < static_cast<int>(supported)) ? requested : supported;
+}
+
+const char* MaskedArgMax::GetName(InstructionSet set) {
+	switch (set) {
+	case InstructionSet::Scalar:
+		return "scalar";
+	case InstructionSet::AVX2:
+		return "avx2";
+	case InstructionSet::AVX512:
+		return "avx512";
+	default:
+		return "best";
+	}
+}
+
+MaskedArgMax::IntegralKernel MaskedArgMax::GetIntegralKernel(InstructionSet set) {
+	switch (Resolve(set)) {
+#ifdef YAGKP_AVX512_KERNELS
+	case InstructionSet::AVX512:
+		return FindAVX512;
+#endif
+#ifdef YAGKP_AVX2_KERNELS
+	case InstructionSet::AVX2:
+		return FindAVX2;
+#endif
+	default:
+		return FindScalar;
+	}
+}
+
+MaskedArgMax::FloatingKernel MaskedArgMax::GetFloatingKernel(InstructionSet set) {
+	switch (Resolve(set)) {
+#ifdef YAGKP_AVX512_KERNELS
+	case InstructionSet::AVX512:
+		return FindAVX512;
+#endif
+#ifdef YAGKP_AVX2_KERNELS
+	case InstructionSet::AVX2:
+		return FindAVX2;
+#endif
+	default:
+		return FindScalar;
+	}
+}
+
+int_t MaskedArgMax::Find(InstructionSet set, const std::int32_t* ids, const real_t* ratings, int_t count, const int_t* weights, int_t limit) {
+	return GetIntegralKernel(set)(ids, ratings, count, weights, limit);
+}
+
+int_t MaskedArgMax::Find(InstructionSet set, const std::int32_t* ids, const real_t* ratings, int_t count, const real_t* weights, real_t own_weight, real_t limit) {
+	return GetFloatingKernel(set)(ids, ratings, count, weights, own_weight, limit);
+}
@@ -0,0 +1,136 @@
+#include <chrono>
+#include <map>
+
+#include "thread_pool.hpp"
+
+// Pool and worker slot of the current thread. Threads that do not belong
+// to any pool (e.g. the main thread) use the slot 0 of the pool they call.
+thread_local const ThreadPool* current_pool = nullptr;
+thread_local int_t current_worker_id = 0_i;
+
+ThreadPool::ThreadPool(int_t threads_count) {
+	threads_count = std::max(threads_count, 1_i);
+
+	workers.reserve(threads_count);
+	for (int_t i = 0_i; i < threads_count; ++i) {
+		workers.push_back(std::make_unique<Worker>());
+	}
+
+	threads.reserve(threads_count - 1_i);
+	for (int_t i = 1_i; i < threads_count; ++i) {
+		threads.emplace_back(&ThreadPool::workerLoop, this, i);
+	}
+}
+
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard<std::mutex> lock(sleep_mutex);
+		stopping.store(true);
+	}
+	sleep_cv.notify_all();
+
+	for (std::thread& thread : threads) {
+		thread.join();
+	}
+}
+
+std::shared_ptr<ThreadPool> ThreadPool::GetInstance(int_t threads_count) {
+	static std::mutex instances_mutex;
+	static std::map<int_t, std::shared_ptr<ThreadPool>> instances;
+
+	threads_count = std::max(threads_count, 1_i);
+
+	std::lock_guard<std::mutex> lock(instances_mutex);
+	std::shared_ptr<ThreadPool>& instance = instances[threads_count];
+	if (!instance) {
+		instance = std::make_shared<ThreadPool>(threads_count);
+	}
+	return instance;
+}
+
+void ThreadPool::push(Task* task) {
+	int_t worker_id = (current_pool == this) ? current_worker_id : 0_i;
+	{
+		std::lock_guard<std::mutex> lock(workers[worker_id]->mutex);
+		workers[worker_id]->tasks.push_back(task);
+	}
+	pending_tasks.fetch_add(1_i, std::memory_order_release);
+
+	{
+		std::lock_guard<std::mutex> lock(sleep_mutex);
+	}
+	sleep_cv.notify_one();
+}
+
+ThreadPool::Task* ThreadPool::pop(int_t worker_id) {
+	Worker& worker = *workers[worker_id];
+
+	std::lock_guard<std::mutex> lock(worker.mutex);
+	if (worker.tasks.empty()) {
+		return nullptr;
+	}
+	Task* task = worker.tasks.back();
+	worker.tasks.pop_back();
+	return task;
+}
+
+ThreadPool::Task* ThreadPool::steal(int_t worker_id) {
+	const int_t threads_count = getThreadsCount();
+
+	for (int_t shift = 1_i; shift < threads_count; ++shift) {
+		Worker& victim = *workers[(worker_id + shift) % threads_count];
+
+		std::lock_guard<std::mutex> lock(victim.mutex);
+		if (!victim.tasks.empty()) {
+			Task* task = victim.tasks.front();
+			victim.tasks.pop_front();
+			return task;
+		}
+	}
+	return nullptr;
+}
+
+bool ThreadPool::tryRunTask() {
+	int_t worker_id = (current_pool == this) ? current_worker_id : 0_i;
+
+	Task* task = pop(worker_id);
+	if (task == nullptr) {
+		task = steal(worker_id);
+	}
+	if (task == nullptr) {
+		return false;
+	}
+
+	pending_tasks.fetch_sub(1_i, std::memory_order_acq_rel);
+
+	// The task may be executed by a thread that belongs to another pool
+	// (or to none), so the slot is switched for the duration of the call
+	const ThreadPool* saved_pool = current_pool;
+	int_t saved_worker_id = current_worker_id;
+
+	current_pool = this;
+	current_worker_id = worker_id;
+
+	(*task)();
+
+	current_pool = saved_pool;
+	current_worker_id = saved_worker_id;
+
+	return true;
+}
+
+void ThreadPool::workerLoop(int_t worker_id) {
+	current_pool = this;
+	current_worker_id = worker_id;
+
+	while (!stopping.load()) {
+		if (tryRunTask()) {
+			continue;
+		}
+
+		std::unique_lock<std::mutex> lock(sleep_mutex);
+		sleep_cv.wait_for(lock, std::chrono::milliseconds(1), [this]() {
+			return stopping.load() || pending_tasks.load(std::memory_order_acquire) > 0_i;
+		});
+	}
+}
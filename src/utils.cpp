@@ -4,8 +4,26 @@
 
 #include "utils.hpp"
 
-std::random_device rd;
-std::mt19937 rng(rd());
+// Counter-based stream: the i-th number is MixBits(seed + i * golden ratio)
+thread_local RandomStreamState random_state = {
+	(static_cast<std::uint64_t>(std::random_device{}()) << 32) | static_cast<std::uint64_t>(std::random_device{}()),
+	0
+};
+
+static std::uint64_t NextRandom() {
+	return MixBits(random_state.seed + 0x9E3779B97F4A7C15ull * ++random_state.counter);
+}
+
+// Uniform number from [0, bound), without the modulo bias
+static std::uint64_t NextRandomBelow(std::uint64_t bound) {
+	const std::uint64_t threshold = (0 - bound) % bound;
+	while (true) {
+		const std::uint64_t value = NextRandom();
+		if (value >= threshold) {
+			return value % bound;
+		}
+	}
+}
 
 Vector<String> GetFileNames(const String& folder, const String& format) {
     Vector<String> file_names;
@@ -18,15 +36,41 @@ Vector<String> GetFileNames(const String& folder, const String& format) {
 }
 
 Vector<int_t> GetRandomPermutation(int_t n) {
-    Vector<int_t> permutation(n);
-    std::iota(permutation.begin(), permutation.end(), 0_i);
+    Vector<int_t> permutation;
+    GetRandomPermutation(n, permutation);
+    return permutation;
+}
 
-    std::shuffle(permutation.begin(), permutation.end(), rng);
+void GetRandomPermutation(int_t n, Vector<int_t>& permutation) {
+    permutation.resize(n);
+    std::iota(permutation.begin(), permutation.end(), 0_i);
 
-    return permutation;
+    // Fisher-Yates shuffle, std::shuffle differs between standard libraries
+    for (int_t i = n - 1_i; i > 0_i; --i) {
+        const int_t j = static_cast<int_t>(NextRandomBelow(static_cast<std::uint64_t>(i) + 1));
+        std::swap(permutation[i], permutation[j]);
+    }
 }
 
 int_t GetRandomInt(int_t n) {
-	std::uniform_int_distribution<int_t> dist(0_i, n - 1_i);
-	return dist(rng);
+	return static_cast<int_t>(NextRandomBelow(static_cast<std::uint64_t>(n)));
+}
+
+void SetRandomSeed(std::uint64_t seed) {
+	random_state.seed = seed;
+	random_state.counter = 0;
+}
+
+std::uint64_t GetRandomSeed() {
+	return NextRandom();
+}
+
+ScopedRandomSeed::ScopedRandomSeed(std::uint64_t seed):
+	saved_state(random_state)
+{
+	SetRandomSeed(seed);
+}
+
+ScopedRandomSeed::~ScopedRandomSeed() {
+	random_state = saved_state;
 }
\ No newline at end of file
@@ -0,0 +1,22 @@
+#pragma once
+
+#include <tuple>
+
+#include "utils.hpp"
+#include "graph.hpp"
+
+// Graphs built in memory, shared by the test files
+
+// `side` x `side` grid with unit vertex and edge weights
+inline Graph<int_t, int_t> MakeGrid(int_t side) {
+    Vector<int_t> weights(side * side, 1_i);
+    Vector<std::tuple<int_t, int_t, int_t>> edges;
+    for (int_t row = 0_i; row < side; ++row) {
+        for (int_t col = 0_i; col < side; ++col) {
+            const int_t v = row * side + col;
+            if (col + 1_i < side) edges.emplace_back(v, v + 1_i, 1_i);
+            if (row + 1_i < side) edges.emplace_back(v, v + side, 1_i);
+        }
+    }
+    return Graph<int_t, int_t>(weights, edges);
+}
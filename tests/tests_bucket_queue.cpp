@@ -0,0 +1,156 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <limits>
+#include <random>
+#include <vector>
+
+#include "bucket_queue.hpp"
+
+TEST(BucketQueue, ExtractsMinimumByDefault) {
+    BucketQueue<int_t> queue(5);
+
+    queue.push(3, 0);
+    queue.push(-2, 1);
+    queue.push(7, 2);
+
+    EXPECT_EQ(queue.size(), 3);
+    EXPECT_EQ(queue.extract(), std::make_pair(-2_i, 1_i));
+    EXPECT_EQ(queue.extract(), std::make_pair(3_i, 0_i));
+    EXPECT_EQ(queue.extract(), std::make_pair(7_i, 2_i));
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(BucketQueue, ExtractsMaximumWithGreater) {
+    BucketQueue<int_t, std::greater<int_t>> queue(5);
+
+    queue.push(3, 0);
+    queue.push(-2, 1);
+    queue.push(7, 2);
+
+    EXPECT_EQ(queue.top(), std::make_pair(7_i, 2_i));
+    queue.changePriority(-5, 2);
+    EXPECT_EQ(queue.extract(), std::make_pair(3_i, 0_i));
+    EXPECT_EQ(queue.extract(), std::make_pair(-2_i, 1_i));
+    EXPECT_EQ(queue.extract(), std::make_pair(-5_i, 2_i));
+}
+
+TEST(BucketQueue, PushOfPresentIndexChangesPriority) {
+    BucketQueue<int_t> queue(3);
+
+    queue.push(10, 0);
+    queue.push(5, 1);
+    queue.push(1, 0);
+
+    EXPECT_EQ(queue.size(), 2);
+    EXPECT_EQ(queue.top(), std::make_pair(1_i, 0_i));
+}
+
+TEST(BucketQueue, ContainsAndClear) {
+    BucketQueue<int_t> queue(4);
+
+    queue.push(100, 1);
+    queue.push(-100, 3);
+
+    EXPECT_TRUE(queue.contains(1));
+    EXPECT_FALSE(queue.contains(2));
+    EXPECT_FALSE(queue.contains(10));
+
+    queue.clear();
+
+    EXPECT_TRUE(queue.empty());
+    EXPECT_FALSE(queue.contains(1));
+    EXPECT_FALSE(queue.contains(3));
+
+    queue.push(0, 3);
+    EXPECT_EQ(queue.extract(), std::make_pair(0_i, 3_i));
+}
+
+TEST(BucketQueue, ThrowsLikeIndexedHeap) {
+    BucketQueue<int_t> queue(2);
+
+    EXPECT_THROW(queue.push(1, 2), std::runtime_error);
+    EXPECT_THROW(queue.extract(), std::runtime_error);
+    EXPECT_THROW(queue.changePriority(1, 0), std::runtime_error);
+}
+
+// Random pushes and extractions with priorities in [-max_priority, max_priority]
+static void CheckPriorityOrder(int_t max_priority) {
+    const int_t n = 200;
+    const int_t absent = std::numeric_limits<int_t>::min();
+
+    std::mt19937 gen(7);
+    std::uniform_int_distribution<int_t> priority(-max_priority, max_priority);
+    std::uniform_int_distribution<int_t> index(0, n - 1);
+
+    BucketQueue<int_t, std::greater<int_t>> queue(n);
+    std::vector<int_t> expected(n, absent);
+    int_t expected_size = 0;
+
+    auto checkExtract = [&]() {
+        auto [value, i] = queue.extract();
+        ASSERT_EQ(expected[i], value);
+        EXPECT_EQ(value, *std::max_element(expected.begin(), expected.end()));
+        expected[i] = absent;
+        --expected_size;
+    };
+
+    for (int_t step = 0; step < 5000; ++step) {
+        if (step % 3 == 2 && expected_size > 0) {
+            checkExtract();
+        }
+        else {
+            int_t value = priority(gen);
+            int_t i = index(gen);
+            if (expected[i] == absent) {
+                ++expected_size;
+            }
+            expected[i] = value;
+            queue.push(value, i);
+        }
+        ASSERT_EQ(queue.size(), expected_size);
+    }
+
+    while (expected_size > 0) {
+        checkExtract();
+    }
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST(BucketQueue, ExtractsElementsInPriorityOrder) {
+    CheckPriorityOrder(50);
+}
+
+TEST(BucketQueue, ExtractsElementsInPriorityOrderWithWideRange) {
+    CheckPriorityOrder(1'000'000'000'000);
+}
+
+TEST(BucketQueue, FallsBackToHeapForWideRange) {
+    BucketQueue<int_t, std::greater<int_t>> queue(4);
+
+    queue.push(1, 0);
+    queue.push(2, 1);
+    EXPECT_FALSE(queue.usesFallback());
+
+    queue.push(1'000'000'000'000, 2);
+    EXPECT_TRUE(queue.usesFallback());
+    EXPECT_EQ(queue.size(), 3);
+    EXPECT_TRUE(queue.contains(0));
+    EXPECT_FALSE(queue.contains(3));
+
+    queue.changePriority(-1'000'000'000'000, 2);
+    EXPECT_EQ(queue.extract(), std::make_pair(2_i, 1_i));
+    EXPECT_EQ(queue.extract(), std::make_pair(1_i, 0_i));
+    EXPECT_EQ(queue.extract(), std::make_pair(-1'000'000'000'000_i, 2_i));
+    EXPECT_TRUE(queue.empty());
+
+    queue.push(5, 3);
+    queue.clear();
+    EXPECT_FALSE(queue.usesFallback());
+    EXPECT_FALSE(queue.contains(3));
+
+    queue.push(3, 1);
+    queue.push(4, 2);
+    EXPECT_FALSE(queue.usesFallback());
+    EXPECT_EQ(queue.extract(), std::make_pair(4_i, 2_i));
+}
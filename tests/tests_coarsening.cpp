@@ -1,8 +1,17 @@
 #include <gtest/gtest.h>
 
+#include <limits>
+#include <random>
+#include <tuple>
+
 #include "utils.hpp" 
 #include "graph.hpp"
+#include "config.hpp"
 #include "coarsening.hpp"
+#include "padded_adjacency.hpp"
+#include "program_statistics.hpp"
+
+#include "test_graphs.hpp"
 
 const std::string DATA_BASE_PATH = "..\\..\\tests\\data\\";
 
@@ -25,10 +34,10 @@ TEST_P(CoarseTest, CoarseLevelsCompressionDecompression) {
     EXPECT_GE(levels.size(), 1);
 
     for (size_t lvl = 1; lvl < levels.size(); ++lvl) {
-        auto& coarse = levels[lvl].coarsed_graph;
+        auto& coarse = levels[lvl].getGraph();
 
         real_t sum_orig = 0;
-        for (int_t v : GraphTester<int_t, real_t>::getVertexWeights(levels[lvl - 1].coarsed_graph)) {
+        for (int_t v : GraphTester<int_t, real_t>::getVertexWeights(levels[lvl - 1].getGraph())) {
             sum_orig += v;
         }
 
@@ -39,12 +48,273 @@ TEST_P(CoarseTest, CoarseLevelsCompressionDecompression) {
 
         EXPECT_TRUE(std::abs(sum_orig - sum_coarse) < EPS);
 
-        EXPECT_EQ(levels[lvl].uncoarse_to_coarse.size(), levels[lvl - 1].coarsed_graph.getVerticesCount());
+        EXPECT_EQ(levels[lvl].uncoarse_to_coarse.size(), levels[lvl - 1].getGraph().getVerticesCount());
+
+        const Vector<int_t>& members_xadj = levels[lvl].coarse_to_uncoarse_xadj;
+        const Vector<vid_t>& members = levels[lvl].coarse_to_uncoarse;
+
+        EXPECT_EQ(members_xadj.size(), coarse.getVerticesCount() + 1);
+        EXPECT_EQ(members.size(), levels[lvl - 1].getGraph().getVerticesCount());
+
+        for (int_t coarse_V = 0; coarse_V < coarse.getVerticesCount(); ++coarse_V) {
+            for (int_t i = members_xadj[coarse_V]; i < members_xadj[coarse_V + 1]; ++i) {
+                EXPECT_EQ(levels[lvl].uncoarse_to_coarse[members[i]], coarse_V);
+            }
+        }
+    }
+}
+
+TEST_P(CoarseTest, ParallelMatchingIsValidAndThreadIndependent) {
+
+    String file_name = GetParam();
+    Graph<int_t, real_t> g(file_name, "mtx");
+
+    const bool saved_parallel_matching = ProgramConfig::coarsening_parallel_matching;
+    const int_t saved_threads_count = ProgramConfig::threads_count;
+
+    ProgramConfig::coarsening_parallel_matching = true;
+
+    ProgramConfig::threads_count = 1;
+    SetRandomSeed(7);
+    Vector<CoarseLevel<int_t, real_t>> sequential_levels = Coarser::GetCoarseLevels(g, 2_i);
+
+    ProgramConfig::threads_count = 4;
+    SetRandomSeed(7);
+    Vector<CoarseLevel<int_t, real_t>> parallel_levels = Coarser::GetCoarseLevels(g, 2_i);
+
+    ProgramConfig::coarsening_parallel_matching = saved_parallel_matching;
+    ProgramConfig::threads_count = saved_threads_count;
+
+    ASSERT_EQ(sequential_levels.size(), parallel_levels.size());
+
+    for (size_t lvl = 1; lvl < parallel_levels.size(); ++lvl) {
+        const Vector<int_t>& members_xadj = parallel_levels[lvl].coarse_to_uncoarse_xadj;
+
+        EXPECT_EQ(sequential_levels[lvl].uncoarse_to_coarse, parallel_levels[lvl].uncoarse_to_coarse);
+
+        for (size_t coarse_V = 0; coarse_V + 1 < members_xadj.size(); ++coarse_V) {
+            EXPECT_LE(members_xadj[coarse_V + 1] - members_xadj[coarse_V], 2);
+        }
+    }
+}
+
+static const ProgramConfig::InstructionSet INSTRUCTION_SETS[] = {
+    ProgramConfig::InstructionSet::Scalar,
+    ProgramConfig::InstructionSet::AVX2,
+    ProgramConfig::InstructionSet::AVX512,
+};
+
+TEST(MaskedArgMax, EverySupportedSetMatchesScalar) {
+
+    std::mt19937_64 gen(11);
+    const int_t n = 64_i;
+
+    for (int_t iteration = 0_i; iteration < 500_i; ++iteration) {
+        const int_t count = PaddedAdjacency::Width * (1_i + iteration % 5_i);
+
+        Vector<std::int32_t> ids(count);
+        Vector<real_t> ratings(count);
+        for (int_t i = 0_i; i < count; ++i) {
+            ids[i] = static_cast<std::int32_t>(gen() % n);
+            // Few distinct ratings give many ties, some rows end with padding
+            ratings[i] = (i >= count - c<int_t>(gen() % 4)) ? -std::numeric_limits<real_t>::infinity() : c<real_t>(gen() % 4);
+        }
+
+        Vector<int_t> int_weights(n);
+        Vector<real_t> real_weights(n);
+        for (int_t v = 0_i; v < n; ++v) {
+            int_weights[v] = (gen() % 8 == 0) ? std::numeric_limits<int_t>::max() : c<int_t>(gen() % 10);
+            real_weights[v] = (gen() % 8 == 0) ? std::numeric_limits<real_t>::infinity() : c<real_t>(gen() % 10) * 0.5_r;
+        }
+
+        const int_t int_limit = c<int_t>(gen() % 10);
+        const real_t own_weight = c<real_t>(gen() % 5);
+        const real_t real_limit = c<real_t>(gen() % 10);
+
+        const int_t expected_int = MaskedArgMax::Find(ProgramConfig::InstructionSet::Scalar, ids.data(), ratings.data(), count, int_weights.data(), int_limit);
+        const int_t expected_real = MaskedArgMax::Find(ProgramConfig::InstructionSet::Scalar, ids.data(), ratings.data(), count, real_weights.data(), own_weight, real_limit);
+
+        for (ProgramConfig::InstructionSet set : INSTRUCTION_SETS) {
+            EXPECT_EQ(MaskedArgMax::Find(set, ids.data(), ratings.data(), count, int_weights.data(), int_limit), expected_int) << MaskedArgMax::GetName(MaskedArgMax::Resolve(set));
+            EXPECT_EQ(MaskedArgMax::Find(set, ids.data(), ratings.data(), count, real_weights.data(), own_weight, real_limit), expected_real) << MaskedArgMax::GetName(MaskedArgMax::Resolve(set));
+        }
+    }
+}
+
+// Random graph with repeated edge weights, so that the matchings have ties
+template <typename vw_t>
+static Graph<vw_t, int_t> MakeRandomGraph(int_t n, int_t edges_count, std::uint64_t seed) {
+    std::mt19937_64 gen(seed);
+
+    Vector<vw_t> weights(n);
+    for (int_t v = 0_i; v < n; ++v) {
+        weights[v] = c<vw_t>(1 + gen() % 3);
+    }
+
+    Vector<std::tuple<int_t, int_t, int_t>> edges;
+    for (int_t i = 0_i; i < edges_count; ++i) {
+        const int_t u = c<int_t>(gen() % n);
+        const int_t v = c<int_t>(gen() % n);
+        if (u != v) edges.emplace_back(u, v, c<int_t>(1 + gen() % 4));
+    }
+    return Graph<vw_t, int_t>(weights, edges);
+}
+
+template <typename vw_t>
+static void ExpectPaddedMatchingMatchesCsr(ProgramConfig::CoarseningMethod method) {
+    Graph<vw_t, int_t> g = MakeRandomGraph<vw_t>(3000_i, 12000_i, 3);
 
-        int_t total_uncoarse = 0;
-        for (auto& vec : levels[lvl].coarse_to_uncoarse) {
-            total_uncoarse += vec.size();
+    PartitionerOptions options;
+    options.coarsening_method = method;
+    options.coarsening_parallel_matching = false;
+    options.coarsening_padded_adjacency = false;
+
+    SetRandomSeed(5);
+    Vector<CoarseLevel<vw_t, int_t>> csr_levels = Coarser::GetCoarseLevels(g, 2_i, options);
+    ASSERT_GT(csr_levels.size(), 2);
+
+    for (ProgramConfig::InstructionSet set : INSTRUCTION_SETS) {
+        options.coarsening_padded_adjacency = true;
+        options.coarsening_instruction_set = set;
+
+        SetRandomSeed(5);
+        Vector<CoarseLevel<vw_t, int_t>> padded_levels = Coarser::GetCoarseLevels(g, 2_i, options);
+
+        ASSERT_EQ(csr_levels.size(), padded_levels.size()) << MaskedArgMax::GetName(MaskedArgMax::Resolve(set));
+        for (size_t lvl = 1; lvl < csr_levels.size(); ++lvl) {
+            EXPECT_EQ(csr_levels[lvl].uncoarse_to_coarse, padded_levels[lvl].uncoarse_to_coarse) << MaskedArgMax::GetName(MaskedArgMax::Resolve(set));
         }
-        EXPECT_EQ(total_uncoarse, levels[lvl - 1].coarsed_graph.getVerticesCount());
     }
-}
\ No newline at end of file
+}
+
+TEST(PaddedAdjacency, HeavyEdgeMatchingMatchesCsr) {
+    ExpectPaddedMatchingMatchesCsr<int_t>(ProgramConfig::CoarseningMethod::HeavyEdgeMatching);
+    ExpectPaddedMatchingMatchesCsr<real_t>(ProgramConfig::CoarseningMethod::HeavyEdgeMatching);
+}
+
+TEST(PaddedAdjacency, HeavyCliqueMatchingMatchesCsr) {
+    ExpectPaddedMatchingMatchesCsr<int_t>(ProgramConfig::CoarseningMethod::HeavyCliqueMatching);
+    ExpectPaddedMatchingMatchesCsr<real_t>(ProgramConfig::CoarseningMethod::HeavyCliqueMatching);
+}
+
+// Hub with `leaves_count` leaves; the matching of a level pairs the hub with one of them
+static Graph<int_t, int_t> MakeStar(int_t leaves_count) {
+    Vector<int_t> weights(leaves_count + 1_i, 1_i);
+    Vector<std::tuple<int_t, int_t, int_t>> edges;
+    for (int_t leaf = 1_i; leaf <= leaves_count; ++leaf) {
+        edges.emplace_back(0_i, leaf, 1_i);
+    }
+    return Graph<int_t, int_t>(weights, edges);
+}
+
+TEST(TwoHopMatching, LeavesOfStarAreMatchedInOneLevel) {
+    Graph<int_t, int_t> g = MakeStar(1000_i);
+
+    PartitionerOptions options;
+    options.coarsening_method = ProgramConfig::CoarseningMethod::HeavyEdgeMatching;
+    options.coarsening_clusterization_prohibition = true;
+
+    SetRandomSeed(3);
+    Vector<CoarseLevel<int_t, int_t>> levels = Coarser::GetCoarseLevels(g, 2_i, options);
+
+    ASSERT_GE(levels.size(), 2);
+    EXPECT_LE(levels[1].getGraph().getVerticesCount(), 501_i);
+    EXPECT_LE(levels.back().getGraph().getVerticesCount(), options.coarsening_vertix_count_limit);
+
+    for (size_t lvl = 1; lvl < levels.size(); ++lvl) {
+        const Vector<int_t>& members_xadj = levels[lvl].coarse_to_uncoarse_xadj;
+        for (size_t coarse_V = 0; coarse_V + 1 < members_xadj.size(); ++coarse_V) {
+            EXPECT_LE(members_xadj[coarse_V + 1] - members_xadj[coarse_V], 2);
+        }
+    }
+}
+
+TEST(TwoHopMatching, StalledCoarseningStops) {
+    Graph<int_t, int_t> g = MakeStar(1000_i);
+
+    PartitionerOptions options;
+    options.coarsening_method = ProgramConfig::CoarseningMethod::HeavyEdgeMatching;
+    options.coarsening_clusterization_prohibition = true;
+    options.coarsening_two_hop_matching = false;
+
+    SetRandomSeed(3);
+    Vector<CoarseLevel<int_t, int_t>> levels = Coarser::GetCoarseLevels(g, 2_i, options);
+
+    // The first level merges only the hub with a leaf
+    ASSERT_EQ(levels.size(), 2);
+    EXPECT_EQ(levels[1].getGraph().getVerticesCount(), 1000_i);
+}
+
+TEST(TwoHopMatching, IsNotRunAfterParallelMatching) {
+    Graph<int_t, int_t> g = MakeStar(1000_i);
+
+    PartitionerOptions options;
+    options.coarsening_method = ProgramConfig::CoarseningMethod::HeavyEdgeMatching;
+    options.coarsening_clusterization_prohibition = true;
+    options.coarsening_parallel_matching = true;
+    options.threads_count = 4_i;
+
+    SetRandomSeed(3);
+    Vector<CoarseLevel<int_t, int_t>> levels = Coarser::GetCoarseLevels(g, 2_i, options);
+
+    ASSERT_EQ(levels.size(), 2);
+    EXPECT_EQ(levels[1].getGraph().getVerticesCount(), 1000_i);
+}
+
+TEST(TwoHopMatching, TwinsAreMatchedWithEachOther) {
+    // Complete bipartite graph K(3, 40): the vertices of the larger side are twins
+    const int_t small_side = 3_i;
+    const int_t large_side = 40_i;
+
+    Vector<int_t> weights(small_side + large_side, 1_i);
+    Vector<std::tuple<int_t, int_t, int_t>> edges;
+    for (int_t u = 0_i; u < small_side; ++u) {
+        for (int_t v = small_side; v < small_side + large_side; ++v) {
+            edges.emplace_back(u, v, 1_i);
+        }
+    }
+    Graph<int_t, int_t> g(weights, edges);
+
+    // The vertices of the smaller side are twins as well, but of a higher degree
+    PartitionerOptions options;
+    options.coarsening_clusterization_prohibition = true;
+    options.coarsening_two_hop_degree_limit = 10_i;
+
+    Vector<int_t> matching(g.getVerticesCount(), -1_i);
+    Vector<int_t> matching_edge_weights(g.getVerticesCount(), 0_i);
+    Coarser::TwoHopMatching(g, 2_i, matching, matching_edge_weights, options);
+
+    for (int_t u = 0_i; u < small_side; ++u) {
+        EXPECT_EQ(matching[u], -1_i);
+    }
+    for (int_t v = small_side; v < small_side + large_side; ++v) {
+        ASSERT_NE(matching[v], -1_i);
+        EXPECT_GE(matching[v], small_side);
+        EXPECT_EQ(matching[matching[v]], v);
+        EXPECT_EQ(matching_edge_weights[v], 0_i);
+    }
+}
+
+TEST(MatchingStatistics, GrowWithTheLevelsOfTheJob) {
+    const int_t saved_itarations_limit = ProgramConfig::coarsening_itarations_limit;
+    ProgramConfig::coarsening_itarations_limit = 2_i;
+    ProgramStatistics::InitMatchingStatistics();
+
+    PartitionerOptions options;
+    options.coarsening_itarations_limit = 6_i;
+    options.coarsening_vertix_count_limit = 10_i;
+
+    Graph<int_t, int_t> g = MakeGrid(40_i);
+
+    SetRandomSeed(1);
+    Vector<CoarseLevel<int_t, int_t>> levels = Coarser::GetCoarseLevels(g, 2_i, options);
+
+    ProgramConfig::collect_mathing_statistics = false;
+    ProgramConfig::coarsening_itarations_limit = saved_itarations_limit;
+
+    ASSERT_GT(levels.size(), 3);
+    ASSERT_GE(ProgramStatistics::denominator.size(), levels.size());
+    for (size_t lvl = 1; lvl < levels.size(); ++lvl) {
+        EXPECT_EQ(ProgramStatistics::denominator[lvl], 1.0_r);
+    }
+}
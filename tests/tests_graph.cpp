@@ -3,6 +3,10 @@
 #include "utils.hpp" 
 #include "graph.hpp"
 
+#include <filesystem>
+#include <fstream>
+#include <system_error>
+
 const std::string DATA_BASE_PATH = "..\\..\\tests\\data\\";
 
 class GraphTest : public ::testing::TestWithParam<std::string> {};
@@ -61,4 +65,160 @@ TEST(GraphTest, equalOperator) {
     Graph<int_t, int_t> g2(weights, edges2);
 
     EXPECT_TRUE(g1 == g2);
-}
\ No newline at end of file
+}
+
+TEST(GraphTest, selectSubgraphKeepsOnlyInnerEdges) {
+
+    Vector<int_t> weights = { 1, 2, 3, 4, 5 };
+
+    Vector<std::tuple<int_t, int_t, int_t>> edges;
+    edges.push_back({ 0, 1, 1 });
+    edges.push_back({ 1, 2, 2 });
+    edges.push_back({ 2, 3, 3 });
+    edges.push_back({ 3, 4, 4 });
+    edges.push_back({ 4, 0, 5 });
+
+    Graph<int_t, int_t> g(weights, edges);
+
+    Vector<int_t> expected_weights = { 5, 1, 4 };
+
+    Vector<std::tuple<int_t, int_t, int_t>> expected_edges;
+    expected_edges.push_back({ 0, 1, 5 });
+    expected_edges.push_back({ 0, 2, 4 });
+
+    Vector<int_t> vertices = { 4, 0, 3 };
+    Graph<int_t, int_t> expected(expected_weights, expected_edges);
+
+    EXPECT_TRUE(g.selectSubgraph(vertices) == expected);
+}
+
+TEST_P(GraphTest, splitByBipartitionMatchesSelectSubgraph) {
+
+    String file_name = GetParam();
+
+    Graph<int_t, real_t> g(file_name, "mtx", true);
+
+    Vector<int_t> partition(g.getVerticesCount());
+    for (int_t v = 0_i; v < g.getVerticesCount(); ++v) {
+        partition[v] = (v % 3_i == 0_i) ? 1_i : 0_i;
+    }
+
+    Vector<int_t> part_vertices[2];
+    auto halves = g.splitByBipartition(partition, part_vertices);
+
+    EXPECT_EQ(part_vertices[0].size() + part_vertices[1].size(), g.getVerticesCount());
+    EXPECT_TRUE(halves.first == g.selectSubgraph(part_vertices[0]));
+    EXPECT_TRUE(halves.second == g.selectSubgraph(part_vertices[1]));
+}
+
+// File of the temporary directory that is removed at the end of the test,
+// also when an assertion fails or an exception is thrown. Tests run as
+// separate processes under ctest, so every test needs its own `name`.
+class TemporaryFile {
+public:
+    explicit TemporaryFile(const String& name):
+        path((std::filesystem::temp_directory_path() / name).string())
+    {}
+
+    ~TemporaryFile() {
+        std::error_code error;
+        std::filesystem::remove(path, error);
+    }
+
+    const String path;
+};
+
+TEST_P(GraphTest, binaryFormatRoundTrip) {
+
+    String file_name = GetParam();
+
+    Graph<int_t, real_t> g(file_name, "mtx", true);
+
+    const TemporaryFile binary_file("yagkp_graph_test_" + std::filesystem::path(file_name).stem().string() + ".bcsr");
+    g.saveBinary(binary_file.path);
+
+    Graph<int_t, real_t> loaded(binary_file.path, "bcsr");
+    Graph<int_t, real_t, int_t> wide(binary_file.path, "bcsr");
+
+    EXPECT_TRUE(g == loaded);
+
+    using Tester = GraphTester<int_t, real_t>;
+    using WideTester = GraphTester<int_t, real_t, int_t>;
+
+    const Vector<vid_t>& adjncy = Tester::getAdjncy(g);
+    const Vector<int_t>& wide_adjncy = WideTester::getAdjncy(wide);
+
+    EXPECT_EQ(WideTester::getXadj(wide), Tester::getXadj(g));
+    EXPECT_TRUE(std::equal(adjncy.begin(), adjncy.end(), wide_adjncy.begin(), wide_adjncy.end()));
+}
+
+TEST(GraphTest, binaryFormatRejectsDamagedFile) {
+
+    Vector<int_t> weights(4, 1);
+
+    Vector<std::tuple<int_t, int_t, int_t>> edges;
+    edges.push_back({ 0, 1, 1 });
+    edges.push_back({ 1, 2, 2 });
+    edges.push_back({ 2, 3, 3 });
+
+    Graph<int_t, int_t> g(weights, edges);
+
+    const TemporaryFile binary_file("yagkp_damaged_test.bcsr");
+    g.saveBinary(binary_file.path);
+
+    {
+        std::fstream file(binary_file.path, std::ios::in | std::ios::out | std::ios::binary);
+        file.seekp(sizeof(BinaryGraphHeader) + 8);
+        file.put(42);
+    }
+
+    EXPECT_THROW((Graph<int_t, int_t>(binary_file.path, "bcsr")), std::runtime_error);
+    EXPECT_THROW((Graph<int_t, real_t>(binary_file.path, "bcsr")), std::runtime_error);
+}
+
+TEST(GraphTest, rejectsTooManyVerticesForTheVertexIdType) {
+
+    const int_t n = c<int_t>(std::numeric_limits<std::int8_t>::max()) + 1_i;
+
+    Vector<int_t> weights(n, 1);
+    Vector<std::tuple<int_t, int_t, int_t>> edges;
+    edges.push_back({ 0, n - 1_i, 1 });
+
+    EXPECT_THROW((Graph<int_t, int_t, std::int8_t>(weights, edges)), std::runtime_error);
+
+    spMtx<int_t> matrix(c<std::size_t>(n), c<std::size_t>(n));
+    EXPECT_THROW((Graph<int_t, int_t, std::int8_t>(matrix)), std::runtime_error);
+
+    Vector<int_t> fitting_weights(n - 1_i, 1);
+    EXPECT_NO_THROW((Graph<int_t, int_t, std::int8_t>(fitting_weights, {})));
+}
+
+TEST_P(GraphTest, mtxReaderMatchesSPMTX) {
+
+    String file_name = GetParam();
+
+    const int_t saved_threads_count = ProgramConfig::threads_count;
+    ProgramConfig::threads_count = 4_i;
+
+    spMtx<real_t> matrix(file_name.c_str(), "mtx");
+    Graph<int_t, real_t> expected(matrix);
+    Graph<int_t, real_t> g(file_name, "mtx");
+
+    ProgramConfig::threads_count = saved_threads_count;
+
+    using Tester = GraphTester<int_t, real_t>;
+
+    ASSERT_EQ(Tester::getXadj(g), Tester::getXadj(expected));
+    ASSERT_EQ(Tester::getAdjncy(g), Tester::getAdjncy(expected));
+
+    for (int_t v = 0_i; v < g.getVerticesCount(); ++v) {
+        Vector<real_t> weights, expected_weights;
+        for (auto [u, w] : g[v]) {
+            weights.push_back(w);
+        }
+        for (auto [u, w] : expected[v]) {
+            expected_weights.push_back(w);
+        }
+        ASSERT_EQ(weights, expected_weights);
+    }
+}
@@ -1,5 +1,9 @@
 #include <gtest/gtest.h>
 
+#include <algorithm>
+#include <random>
+#include <vector>
+
 #include "heap.hpp" 
 
 using Heap = IndexedHeap<int>;
@@ -116,4 +120,120 @@ TEST(IndexedHeap, ExtractFromEmpty) {
 TEST(IndexedHeap, TopFromEmpty) {
     Heap heap(2);
     EXPECT_ANY_THROW(heap.top());
-}
\ No newline at end of file
+}
+
+TEST(IndexedHeap, ContainsAndClear) {
+    Heap heap(4);
+    heap.push(5, 0);
+    heap.push(2, 3);
+
+    EXPECT_TRUE(heap.contains(0));
+    EXPECT_TRUE(heap.contains(3));
+    EXPECT_FALSE(heap.contains(1));
+    EXPECT_EQ(heap.size(), 2);
+
+    heap.clear();
+
+    EXPECT_TRUE(heap.empty());
+    EXPECT_FALSE(heap.contains(0));
+
+    heap.push(7, 3);
+    EXPECT_EQ(heap.top().second, 3);
+}
+
+using DaryHeap = DaryIndexedHeap<int>;
+
+TEST(DaryIndexedHeap, ExtractMaintainsHeapProperty) {
+    DaryHeap heap(20);
+    for (int i = 0; i < 20; i++) {
+        heap.push((i * 7) % 20, i);
+    }
+
+    int previous = -1;
+    while (!heap.empty()) {
+        auto [value, index] = heap.extract();
+        EXPECT_GE(value, previous);
+        EXPECT_EQ(value, (index * 7) % 20);
+        EXPECT_FALSE(heap.contains(index));
+        previous = value;
+    }
+}
+
+TEST(DaryIndexedHeap, ChangePriorityUpAndDown) {
+    DaryIndexedHeap<int, std::greater<int>, 3> heap(5);
+    heap.push(10, 0);
+    heap.push(20, 1);
+    heap.push(30, 2);
+
+    heap.changePriority(5, 2);
+    EXPECT_EQ(heap.top(), std::make_pair(20, 1_i));
+
+    heap.changePriority(40, 0);
+    EXPECT_EQ(heap.top(), std::make_pair(40, 0_i));
+}
+
+TEST(DaryIndexedHeap, ThrowsLikeIndexedHeap) {
+    DaryHeap heap(2);
+    EXPECT_ANY_THROW(heap.push(1, 2));
+    EXPECT_ANY_THROW(heap.extract());
+    EXPECT_ANY_THROW(heap.top());
+    EXPECT_ANY_THROW(heap.changePriority(1, 0));
+}
+
+TEST(DaryIndexedHeap, ReserveKeepsElements) {
+    DaryHeap heap(2);
+    heap.push(5, 0);
+    heap.push(2, 1);
+
+    heap.reserve(10);
+
+    EXPECT_EQ(heap.getCapacity(), 10);
+    EXPECT_EQ(heap.size(), 2);
+    EXPECT_FALSE(heap.contains(9));
+
+    heap.push(1, 9);
+    EXPECT_EQ(heap.extract(), std::make_pair(1, 9_i));
+    EXPECT_EQ(heap.extract(), std::make_pair(2, 1_i));
+    EXPECT_EQ(heap.extract(), std::make_pair(5, 0_i));
+}
+
+TEST(DaryIndexedHeap, ExtractsSameSequenceAsIndexedHeap) {
+    const int_t n = 300;
+
+    std::mt19937 gen(11);
+    std::uniform_int_distribution<int> priority(-1000000, 1000000);
+    std::uniform_int_distribution<int_t> index(0, n - 1);
+
+    DaryHeap dary_heap(n);
+    Heap heap(n);
+
+    // Distinct priorities, so both heaps extract the same indices
+    std::vector<int> used;
+    auto uniquePriority = [&]() {
+        while (true) {
+            int value = priority(gen);
+            if (std::find(used.begin(), used.end(), value) == used.end()) {
+                used.push_back(value);
+                return value;
+            }
+        }
+    };
+
+    for (int_t step = 0; step < 3000; ++step) {
+        if (step % 4 == 3 && !heap.empty()) {
+            EXPECT_EQ(dary_heap.extract(), heap.extract());
+        }
+        else {
+            int value = uniquePriority();
+            int_t i = index(gen);
+            dary_heap.push(value, i);
+            heap.push(value, i);
+        }
+        ASSERT_EQ(dary_heap.size(), heap.size());
+    }
+
+    while (!heap.empty()) {
+        EXPECT_EQ(dary_heap.extract(), heap.extract());
+    }
+    EXPECT_TRUE(dary_heap.empty());
+}
@@ -0,0 +1,131 @@
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <thread>
+
+#include "utils.hpp"
+#include "config.hpp"
+#include "graph.hpp"
+#include "partitioner.hpp"
+#include "instrumentation.hpp"
+
+#include "test_graphs.hpp"
+
+#ifdef YAGKP_INSTRUMENTATION
+
+TEST(Instrumentation, DoesNothingOutsideOfSession) {
+    EXPECT_FALSE(Instrumentation::IsActive());
+
+    Instrumentation::ScopedTimer timer("phase");
+    Instrumentation::Count("counter", 5.0_r);
+
+    EXPECT_FALSE(Instrumentation::IsActive());
+}
+
+TEST(Instrumentation, AggregatesTimersAndValuesByName) {
+    {
+        Instrumentation::Session session("root", true);
+        for (int_t i = 0_i; i < 3_i; ++i) {
+            Instrumentation::ScopedTimer timer("phase");
+            Instrumentation::Count("moves", 2.0_r);
+            Instrumentation::Sample("ratio", c<real_t>(i));
+        }
+        Instrumentation::ScopedTimer timer("level", 4_i);
+    }
+
+    Instrumentation::Report report = Instrumentation::GetLastReport();
+    ASSERT_NE(report, nullptr);
+    EXPECT_EQ(report->name, "root");
+    EXPECT_EQ(report->calls, 1_i);
+    EXPECT_EQ(report->children.size(), 2);
+
+    const Instrumentation::Node* phase = report->findChild("phase");
+    ASSERT_NE(phase, nullptr);
+    EXPECT_EQ(phase->calls, 3_i);
+    EXPECT_EQ(phase->findValue("moves")->sum, 6.0_r);
+
+    const Instrumentation::Statistic* ratio = phase->findValue("ratio");
+    ASSERT_NE(ratio, nullptr);
+    EXPECT_EQ(ratio->min, 0.0_r);
+    EXPECT_EQ(ratio->max, 2.0_r);
+    EXPECT_EQ(ratio->getMean(), 1.0_r);
+
+    EXPECT_NE(report->findChild("level 4"), nullptr);
+    EXPECT_FALSE(Instrumentation::IsActive());
+}
+
+TEST(Instrumentation, ReportsPartitioningPhases) {
+    Graph<int_t, int_t> g = MakeGrid(30_i);
+
+    PartitionerOptions options;
+    options.collect_instrumentation = true;
+    options.threads_count = 4_i;
+
+    Vector<int_t> partition;
+    Partitioner::GetGraphKPartition(g, 4_i, partition, options);
+
+    Instrumentation::Report report = Instrumentation::GetLastReport();
+    ASSERT_NE(report, nullptr);
+    EXPECT_EQ(report->name, "GetGraphKPartition");
+
+    // Top level bisection and the bisections of both halves below it
+    const Instrumentation::Node* bisection = report->findChild("recursive_bisection");
+    ASSERT_NE(bisection, nullptr);
+    EXPECT_EQ(bisection->calls, 1_i);
+
+    const Instrumentation::Node* coarsening = bisection->findChild("coarsening");
+    ASSERT_NE(coarsening, nullptr);
+    const Instrumentation::Node* level = coarsening->findChild("level 1");
+    ASSERT_NE(level, nullptr);
+    EXPECT_LT(level->findValue("contraction_ratio")->max, 1.0_r);
+
+    const Instrumentation::Node* initial_bisection = bisection->findChild("initial_bisection");
+    ASSERT_NE(initial_bisection, nullptr);
+    EXPECT_GT(initial_bisection->findValue("launches")->sum, 0.0_r);
+    EXPECT_NE(bisection->findChild("uncoarsening"), nullptr);
+
+    const Instrumentation::Node* nested = bisection->findChild("recursive_bisection");
+    ASSERT_NE(nested, nullptr);
+    EXPECT_EQ(nested->calls, 2_i);
+
+    EXPECT_NE(report->findChild("post_processing"), nullptr);
+
+    std::stringstream text;
+    Instrumentation::PrintReport(text, *report);
+    EXPECT_NE(text.str().find("GetGraphKPartition"), String::npos);
+}
+
+TEST(Instrumentation, ConcurrentCallsFillTheirOwnReports) {
+    Graph<int_t, int_t> g = MakeGrid(30_i);
+
+    // A bisection has no nested recursive bisection, a 4-way partition has two
+    auto countNestedBisections = [](const Instrumentation::Report& report) {
+        const Instrumentation::Node* nested = report->findChild("recursive_bisection")->findChild("recursive_bisection");
+        return nested == nullptr ? 0_i : nested->calls;
+    };
+
+    for (int_t attempt = 0_i; attempt < 5_i; ++attempt) {
+        Instrumentation::Report reports[2];
+        Vector<std::thread> jobs;
+        for (int_t job = 0_i; job < 2_i; ++job) {
+            jobs.emplace_back([&, job]() {
+                PartitionerOptions options;
+                options.collect_instrumentation = true;
+                options.instrumentation_report = &reports[job];
+
+                Vector<int_t> partition;
+                Partitioner::GetGraphKPartition(g, job == 0_i ? 2_i : 4_i, partition, options);
+            });
+        }
+        for (std::thread& job : jobs) {
+            job.join();
+        }
+
+        ASSERT_NE(reports[0], nullptr);
+        ASSERT_NE(reports[1], nullptr);
+        EXPECT_EQ(countNestedBisections(reports[0]), 0_i);
+        EXPECT_EQ(countNestedBisections(reports[1]), 2_i);
+    }
+}
+
+#endif
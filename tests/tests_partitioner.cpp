@@ -0,0 +1,411 @@
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <random>
+#include <thread>
+#include <tuple>
+
+#include "utils.hpp"
+#include "config.hpp"
+#include "graph.hpp"
+#include "partitioner.hpp"
+
+#include "test_graphs.hpp"
+
+TEST(Partitioner, configSeedGivesSamePartitionForAnyThreadsCount) {
+	Graph<int_t, int_t> g = MakeGrid(40_i);
+
+	const int_t k = 6_i;
+	const int_t saved_threads_count = ProgramConfig::threads_count;
+	const int_t saved_seed = ProgramConfig::random_seed;
+	ProgramConfig::random_seed = 123_i;
+
+	Vector<int_t> sequential_partition;
+	ProgramConfig::threads_count = 1_i;
+	SetRandomSeed(1);
+	Partitioner::GetGraphKPartition(g, k, sequential_partition);
+
+	Vector<int_t> parallel_partition;
+	ProgramConfig::threads_count = 3_i;
+	SetRandomSeed(2);
+	Partitioner::GetGraphKPartition(g, k, parallel_partition);
+
+	ProgramConfig::threads_count = saved_threads_count;
+	ProgramConfig::random_seed = saved_seed;
+
+	EXPECT_EQ(sequential_partition, parallel_partition);
+}
+
+TEST(Partitioner, concurrentCallsWithDifferentOptionsMatchSequentialCalls) {
+	Graph<int_t, int_t> g = MakeGrid(40_i);
+
+	PartitionerOptions first;
+	first.random_seed = 7_i;
+	first.threads_count = 2_i;
+	first.accuracy = 0.01_r;
+
+	PartitionerOptions second = first;
+	second.random_seed = 11_i;
+	second.threads_count = 3_i;
+	second.accuracy = 0.10_r;
+	second.partitioning_method = ProgramConfig::PartitioningMethod::DirectKWay;
+	second.coarsening_method = ProgramConfig::CoarseningMethod::HeavyCliqueMatching;
+
+	Vector<int_t> first_sequential, second_sequential;
+	Partitioner::GetGraphKPartition(g, 4_i, first_sequential, first);
+	Partitioner::GetGraphKPartition(g, 8_i, second_sequential, second);
+
+	// The jobs use pools with different thread counts at the same time
+	for (int_t attempt = 0_i; attempt < 3_i; ++attempt) {
+		Vector<int_t> first_concurrent, second_concurrent;
+		std::thread first_job([&]() { Partitioner::GetGraphKPartition(g, 4_i, first_concurrent, first); });
+		std::thread second_job([&]() { Partitioner::GetGraphKPartition(g, 8_i, second_concurrent, second); });
+		first_job.join();
+		second_job.join();
+
+		EXPECT_EQ(first_sequential, first_concurrent);
+		EXPECT_EQ(second_sequential, second_concurrent);
+	}
+
+	// Every thread count keeps its own pool
+	std::shared_ptr<ThreadPool> first_pool = ThreadPool::GetInstance(first.threads_count);
+	std::shared_ptr<ThreadPool> second_pool = ThreadPool::GetInstance(second.threads_count);
+	EXPECT_EQ(first_pool, ThreadPool::GetInstance(first.threads_count));
+	EXPECT_EQ(second_pool->getThreadsCount(), 3_i);
+}
+
+TEST(Partitioner, basicPartitionerMatchesRuntimeDispatch) {
+	Graph<int_t, int_t> g = MakeGrid(30_i);
+
+	PartitionerOptions options;
+	options.random_seed = 5_i;
+	options.coarsening_method = ProgramConfig::CoarseningMethod::HeavyCliqueMatching;
+	options.bipartitioning_method = ProgramConfig::BipartitioningMethod::GraphGrowingAlgorithm;
+	options.uncoarsening_method = ProgramConfig::UncoarseningMethod::FiducciaMattheyses;
+
+	Vector<int_t> runtime_partition;
+	Partitioner::GetGraphKPartition(g, 4_i, runtime_partition, options);
+
+	Vector<int_t> static_partition;
+	BasicPartitioner<
+		MatchingStrategy<ProgramConfig::CoarseningMethod::HeavyCliqueMatching>,
+		BipartitioningStrategy<ProgramConfig::BipartitioningMethod::GraphGrowingAlgorithm>,
+		RefinementStrategy<ProgramConfig::UncoarseningMethod::FiducciaMattheyses>
+	>::GetGraphKPartition(g, 4_i, static_partition, options);
+
+	EXPECT_EQ(runtime_partition, static_partition);
+}
+
+TEST(Bipartitioner, multiStartEarlyStopIsThreadIndependent) {
+	Graph<int_t, int_t> g = MakeGrid(20_i);
+	const int_t n = g.getVerticesCount();
+
+	// Random bipartitions: the best edge cut improves less and less often
+	std::atomic<int_t> launches_count = 0_i;
+	auto launch = [&](Bipartitioner::LaunchScratch<int_t, int_t>& scratch) {
+		++launches_count;
+		Vector<int_t>& partition = scratch.partition.get();
+		partition.resize(n);
+		for (int_t v = 0_i; v < n; ++v) {
+			partition[v] = GetRandomInt(2_i);
+		}
+	};
+
+	PartitionerOptions options;
+	options.bipartitioning_launches_without_improvement_limit = 5_i;
+
+	options.threads_count = 1_i;
+	SetRandomSeed(9);
+	Vector<int_t> sequential_partition = Bipartitioner::MultiStart(g, 200_i, launch, options);
+	ASSERT_LT(launches_count, 200_i);
+
+	for (int_t threads_count : { 2_i, 3_i, 8_i }) {
+		options.threads_count = threads_count;
+		SetRandomSeed(9);
+		EXPECT_EQ(Bipartitioner::MultiStart(g, 200_i, launch, options), sequential_partition) << threads_count << " threads";
+	}
+}
+
+TEST(Bipartitioner, multiStartStopsAfterLaunchesWithoutImprovement) {
+	Graph<int_t, int_t> g = MakeGrid(10_i);
+	const int_t n = g.getVerticesCount();
+	const int_t limit = 6_i;
+
+	// Every launch returns the same bipartition, so only the first one improves the edge cut
+	std::atomic<int_t> launches_count = 0_i;
+	auto launch = [&](Bipartitioner::LaunchScratch<int_t, int_t>& scratch) {
+		++launches_count;
+		Vector<int_t>& partition = scratch.partition.get();
+		partition.resize(n);
+		for (int_t v = 0_i; v < n; ++v) {
+			partition[v] = (v < n / 2_i) ? 0_i : 1_i;
+		}
+	};
+
+	PartitionerOptions options;
+	options.bipartitioning_launches_without_improvement_limit = limit;
+
+	options.threads_count = 1_i;
+	Bipartitioner::MultiStart(g, 100_i, launch, options);
+	EXPECT_EQ(launches_count, limit + 1_i);
+
+	// Launches run in batches of `threads_count`, the batch of the last counted launch is finished
+	options.threads_count = 4_i;
+	launches_count = 0_i;
+	Bipartitioner::MultiStart(g, 100_i, launch, options);
+	EXPECT_EQ(launches_count, (limit + 1_i + 3_i) / 4_i * 4_i);
+
+	// Without the limit all launches are run
+	options.bipartitioning_launches_without_improvement_limit = 0_i;
+	launches_count = 0_i;
+	Bipartitioner::MultiStart(g, 100_i, launch, options);
+	EXPECT_EQ(launches_count, 100_i);
+}
+
+// Greedy graph growing that recomputes the gain of every neighbour from its adjacency
+static void ReferenceGreedyGrowing(const Graph<int_t, int_t>& g, real_t accuracy, Bipartitioner::LaunchScratch<int_t, int_t>& scratch) {
+	const int_t n = g.getVerticesCount();
+	const int_t max_allowed = (accuracy + 1.0_r) * (g.getSumOfVertexWeights() / 2_i);
+
+	Vector<int_t>& partition = scratch.partition.get();
+	Vector<bool>& blocked = scratch.visited.get();
+	Vector<int_t>& order = scratch.order.get();
+	GainPriorityQueue<int_t>& heap = scratch.heap.get();
+
+	partition.assign(n, 0_i);
+	blocked.assign(n, false);
+	GetRandomPermutation(n, order);
+
+	auto part_weights = [&](int_t V, int_t& to_part0, int_t& to_part1) {
+		to_part0 = 0_i;
+		to_part1 = 0_i;
+		for (auto [near_V, w] : g[V]) {
+			(partition[near_V] == 0_i ? to_part0 : to_part1) += w;
+		}
+	};
+
+	int_t current_weight = 0_i;
+	bool flag = true;
+	while (flag) {
+		flag = false;
+
+		for (int_t V : order) {
+			if (!blocked[V] && g.getVertexWeight(V) + current_weight <= max_allowed) {
+				flag = true;
+				blocked[V] = true;
+				partition[V] = 1_i;
+				for (auto [next_V, w] : g[V]) {
+					int_t to_part0, to_part1;
+					part_weights(next_V, to_part0, to_part1);
+					heap.push(to_part0 - w, next_V);
+				}
+				break;
+			}
+		}
+
+		while (!heap.empty()) {
+			auto [priority, curr_V] = heap.extract();
+			blocked[curr_V] = true;
+			if (current_weight + g.getVertexWeight(curr_V) > max_allowed) {
+				continue;
+			}
+			current_weight += g.getVertexWeight(curr_V);
+			partition[curr_V] = 1_i;
+
+			for (auto [next_V, w] : g[curr_V]) {
+				if (blocked[next_V]) continue;
+				int_t to_part0, to_part1;
+				part_weights(next_V, to_part0, to_part1);
+				heap.push(to_part0 - to_part1, next_V);
+			}
+		}
+	}
+}
+
+TEST(Bipartitioner, greedyGrowingMatchesRecomputedGains) {
+	// Grid with random edge weights, so that gains differ
+	const int_t side = 25_i;
+	std::mt19937_64 gen(4);
+	Vector<int_t> weights(side * side, 1_i);
+	Vector<std::tuple<int_t, int_t, int_t>> edges;
+	for (int_t row = 0_i; row < side; ++row) {
+		for (int_t col = 0_i; col < side; ++col) {
+			const int_t v = row * side + col;
+			if (col + 1_i < side) edges.emplace_back(v, v + 1_i, c<int_t>(1 + gen() % 9));
+			if (row + 1_i < side) edges.emplace_back(v, v + side, c<int_t>(1 + gen() % 9));
+		}
+	}
+	Graph<int_t, int_t> g(weights, edges);
+
+	PartitionerOptions options;
+	options.threads_count = 1_i;
+
+	for (int_t launches_count : { 1_i, 20_i }) {
+		options.bipartitioning_GreedyGraphGrowingAlgorithm_launches_count = launches_count;
+
+		SetRandomSeed(13);
+		Vector<int_t> partition = Bipartitioner::GreedyGraphGrowingAlgorithm(g, options);
+
+		SetRandomSeed(13);
+		Vector<int_t> expected = Bipartitioner::MultiStart(g, launches_count, [&](Bipartitioner::LaunchScratch<int_t, int_t>& scratch) {
+			ReferenceGreedyGrowing(g, options.accuracy, scratch);
+		}, options);
+
+		EXPECT_EQ(partition, expected) << launches_count << " launches";
+	}
+}
+
+const String DATA_BASE_PATH = "..\\..\\tests\\data\\";
+
+class PartitionerTest : public ::testing::TestWithParam<String> {};
+
+INSTANTIATE_TEST_SUITE_P(
+	AllMtxFiles,
+	PartitionerTest,
+	::testing::ValuesIn(GetFileNames(DATA_BASE_PATH, ".mtx"))
+);
+
+TEST_P(PartitionerTest, parallelPartitionMatchesSequential) {
+
+	String file_name = GetParam();
+	Graph<int_t, real_t> g(file_name, "mtx", true);
+
+	const int_t k = 8_i;
+	const int_t saved_threads_count = ProgramConfig::threads_count;
+
+	Vector<int_t> sequential_partition;
+	ProgramConfig::threads_count = 1_i;
+	SetRandomSeed(42);
+	Partitioner::GetGraphKPartition(g, k, sequential_partition);
+
+	Vector<int_t> parallel_partition;
+	ProgramConfig::threads_count = 4_i;
+	SetRandomSeed(42);
+	Partitioner::GetGraphKPartition(g, k, parallel_partition);
+
+	ProgramConfig::threads_count = saved_threads_count;
+
+	EXPECT_EQ(sequential_partition, parallel_partition);
+}
+
+TEST_P(PartitionerTest, directKWayGivesValidPartition) {
+
+	String file_name = GetParam();
+	Graph<int_t, real_t> g(file_name, "mtx", true);
+
+	const int_t k = std::min<int_t>(8_i, g.getVerticesCount());
+	const ProgramConfig::PartitioningMethod saved_method = ProgramConfig::partitioning_method;
+
+	Vector<int_t> partition;
+	ProgramConfig::partitioning_method = ProgramConfig::PartitioningMethod::DirectKWay;
+	Partitioner::GetGraphKPartition(g, k, partition);
+	ProgramConfig::partitioning_method = saved_method;
+
+	ASSERT_EQ(partition.size(), g.getVerticesCount());
+
+	Vector<int_t> part_size(k, 0_i);
+	for (int_t part : partition) {
+		ASSERT_GE(part, 0_i);
+		ASSERT_LT(part, k);
+		++part_size[part];
+	}
+	for (int_t size : part_size) {
+		EXPECT_GT(size, 0_i);
+	}
+}
+
+TEST_P(PartitionerTest, improveFinalPartitionKeepsBalanceAndIsThreadIndependent) {
+
+	String file_name = GetParam();
+	Graph<int_t, real_t> g(file_name, "mtx", true);
+
+	const int_t k = std::min<int_t>(8_i, g.getVerticesCount());
+	const int_t n = g.getVerticesCount();
+	const int_t saved_threads_count = ProgramConfig::threads_count;
+
+	Vector<int_t> initial_partition(n);
+	for (int_t v = 0_i; v < n; ++v) {
+		initial_partition[v] = v % k;
+	}
+
+	Vector<int_t> sequential_partition = initial_partition;
+	ProgramConfig::threads_count = 1_i;
+	PostProcessor::ImproveFinalPartition(g, k, sequential_partition);
+
+	Vector<int_t> parallel_partition = initial_partition;
+	ProgramConfig::threads_count = 4_i;
+	PostProcessor::ImproveFinalPartition(g, k, parallel_partition);
+
+	ProgramConfig::threads_count = saved_threads_count;
+
+	EXPECT_EQ(sequential_partition, parallel_partition);
+	EXPECT_LE(PartitionMetrics::GetEdgeCut(g, sequential_partition), PartitionMetrics::GetEdgeCut(g, initial_partition));
+
+	int_t max_allowed = c<int_t>(c<real_t>(n) / c<real_t>(k) * (1.0_r + ProgramConfig::accuracy + EPS));
+	while (max_allowed * k < n) {
+		++max_allowed;
+	}
+
+	Vector<int_t> part_size(k, 0_i);
+	for (int_t part : sequential_partition) {
+		++part_size[part];
+	}
+	for (int_t size : part_size) {
+		EXPECT_LE(size, std::max(max_allowed, (n + k - 1_i) / k));
+	}
+}
+
+TEST(PostProcessor, improveFinalPartitionNeverIncreasesEdgeCut) {
+
+	// Vertices 0 and 1 both gain from moving to the part of the other one
+	Graph<int_t, int_t> g(Vector<int_t>(4_i, 1_i), Vector<std::tuple<int_t, int_t, int_t>>{
+		{ 0_i, 1_i, 5_i },
+		{ 0_i, 2_i, 1_i },
+		{ 1_i, 3_i, 1_i },
+	});
+	const Vector<int_t> initial_partition = { 0_i, 1_i, 0_i, 1_i };
+	const int_t initial_cut = PartitionMetrics::GetEdgeCut(g, initial_partition);
+
+	for (int_t threads_count : { 1_i, 4_i }) {
+		for (int_t rounds_limit : { 1_i, 2_i, 3_i, 16_i }) {
+			PartitionerOptions options;
+			options.accuracy = 0.5_r;
+			options.threads_count = threads_count;
+			options.post_processing_improvement_rounds_limit = rounds_limit;
+
+			Vector<int_t> partition = initial_partition;
+			PostProcessor::ImproveFinalPartition(g, 2_i, partition, options);
+
+			EXPECT_LT(PartitionMetrics::GetEdgeCut(g, partition), initial_cut);
+		}
+	}
+}
+
+TEST(ThreadPoolTest, forkJoinRunsBothTasks) {
+
+	ThreadPool pool(4_i);
+
+	std::function<int_t(int_t)> sum = [&](int_t depth) -> int_t {
+		if (depth == 0_i) {
+			return 1_i;
+		}
+		int_t left = 0_i, right = 0_i;
+		pool.ForkJoin(
+			[&]() { left = sum(depth - 1_i); },
+			[&]() { right = sum(depth - 1_i); }
+		);
+		return left + right;
+	};
+
+	EXPECT_EQ(sum(10_i), 1024_i);
+}
+
+TEST(ThreadPoolTest, forkJoinRethrowsExceptions) {
+
+	ThreadPool pool(2_i);
+
+	EXPECT_ANY_THROW(pool.ForkJoin(
+		[]() {},
+		[]() { throw std::runtime_error("Task failed!"); }
+	));
+}
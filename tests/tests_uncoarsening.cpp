@@ -0,0 +1,164 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <random>
+#include <tuple>
+
+#include "utils.hpp"
+#include "graph.hpp"
+#include "config.hpp"
+#include "coarsening.hpp"
+#include "uncoarsening.hpp"
+#include "metrics.hpp"
+
+// Grid with random edge weights, its first coarse level and a bipartition of
+// that level into the upper and the lower half of the grid
+class BoundaryRefinementTest : public ::testing::Test {
+protected:
+    const int_t side = 40_i;
+
+    Graph<int_t, int_t> graph;
+    Vector<CoarseLevel<int_t, int_t>> levels;
+    Vector<int_t> coarse_partition;
+
+    void SetUp() override {
+        std::mt19937_64 gen(17);
+        Vector<int_t> weights(side * side, 1_i);
+        Vector<std::tuple<int_t, int_t, int_t>> edges;
+        for (int_t row = 0_i; row < side; ++row) {
+            for (int_t col = 0_i; col < side; ++col) {
+                const int_t v = row * side + col;
+                if (col + 1_i < side) edges.emplace_back(v, v + 1_i, c<int_t>(1 + gen() % 9));
+                if (row + 1_i < side) edges.emplace_back(v, v + side, c<int_t>(1 + gen() % 9));
+            }
+        }
+        graph = Graph<int_t, int_t>(weights, edges);
+
+        PartitionerOptions options;
+        options.coarsening_vertix_count_limit = graph.getVerticesCount() - 1_i;
+        SetRandomSeed(2);
+        levels = Coarser::GetCoarseLevels(graph, 2_i, options);
+        ASSERT_EQ(levels.size(), 2);
+
+        const CoarseLevel<int_t, int_t>& level = levels[1];
+        coarse_partition.assign(level.getGraph().getVerticesCount(), 0_i);
+        for (int_t coarse_V = 0_i; coarse_V < level.getGraph().getVerticesCount(); ++coarse_V) {
+            const int_t first_V = level.coarse_to_uncoarse[level.coarse_to_uncoarse_xadj[coarse_V]];
+            coarse_partition[coarse_V] = (first_V / side < side / 2_i) ? 0_i : 1_i;
+        }
+    }
+
+    Vector<int_t> GetProjection() const {
+        Vector<int_t> partition;
+        Uncoarser::DirectMapping<int_t, int_t>(levels[0], levels[1], coarse_partition, partition);
+        return partition;
+    }
+};
+
+TEST_F(BoundaryRefinementTest, CandidatesAreMembersOfCoarseCutVertices) {
+    const CoarseLevel<int_t, int_t>& level = levels[1];
+    const Graph<int_t, int_t>& coarse_graph = level.getGraph();
+
+    Vector<int_t> candidates;
+    Uncoarser::GetBoundaryCandidates(level, coarse_partition, candidates);
+
+    Vector<bool> is_candidate(graph.getVerticesCount(), false);
+    for (int_t curr_V : candidates) {
+        EXPECT_FALSE(is_candidate[curr_V]);
+        is_candidate[curr_V] = true;
+
+        // Its coarse vertex is on the cut
+        const int_t coarse_V = level.uncoarse_to_coarse[curr_V];
+        bool on_cut = false;
+        for (auto [next_V, w] : coarse_graph[coarse_V]) {
+            on_cut = on_cut || coarse_partition[next_V] != coarse_partition[coarse_V];
+        }
+        EXPECT_TRUE(on_cut);
+    }
+
+    // Every vertex on the cut of the projection is a candidate
+    const Vector<int_t> partition = GetProjection();
+    for (int_t curr_V = 0_i; curr_V < graph.getVerticesCount(); ++curr_V) {
+        for (auto [next_V, w] : graph[curr_V]) {
+            if (partition[next_V] != partition[curr_V]) {
+                EXPECT_TRUE(is_candidate[curr_V]);
+            }
+        }
+    }
+
+    EXPECT_LT(candidates.size(), graph.getVerticesCount() / 4_i);
+}
+
+// Kernighan-Lin pass that starts from every vertex of the level
+static void ReferenceKernighanLin(const Graph<int_t, int_t>& graph, Vector<int_t>& partition) {
+    const int_t n = graph.getVerticesCount();
+
+    int_t total_weight[2] = { 0_i, 0_i };
+    for (int_t curr_V = 0_i; curr_V < n; ++curr_V) {
+        total_weight[partition[curr_V]] += graph.getVertexWeight(curr_V);
+    }
+
+    Vector<bool> blocked(n, false);
+    for (int_t curr_V = 0_i; curr_V < n; ++curr_V) {
+        blocked[curr_V] = total_weight[partition[curr_V]] < total_weight[1_i - partition[curr_V]];
+    }
+
+    auto priority = [&](int_t curr_V) {
+        int_t inc_w = 0_i, dec_w = 0_i;
+        for (auto [next_V, w] : graph[curr_V]) {
+            (partition[next_V] == partition[curr_V] ? inc_w : dec_w) += w;
+        }
+        return std::pair<int_t, int_t>(inc_w, dec_w);
+    };
+
+    GainPriorityQueue<int_t> heap(n);
+    for (int_t curr_V = 0_i; curr_V < n; ++curr_V) {
+        if (blocked[curr_V]) continue;
+        auto [inc_w, dec_w] = priority(curr_V);
+        if (dec_w == 0_i && inc_w != 0_i) continue;
+        heap.push(inc_w - dec_w, curr_V);
+    }
+
+    while (!heap.empty()) {
+        auto [gain, curr_V] = heap.extract();
+        blocked[curr_V] = true;
+        if (gain > 0_i) break;
+
+        partition[curr_V] = 1_i - partition[curr_V];
+        for (auto [next_V, w] : graph[curr_V]) {
+            if (blocked[next_V]) continue;
+            auto [inc_w, dec_w] = priority(next_V);
+            heap.push(inc_w - dec_w, next_V);
+        }
+    }
+}
+
+TEST_F(BoundaryRefinementTest, KernighanLinMatchesFullScan) {
+    PartitionerOptions options;
+
+    Vector<int_t> partition;
+    Uncoarser::KernighanLin<int_t, int_t>(levels[0], levels[1], coarse_partition, partition, options);
+
+    Vector<int_t> expected = GetProjection();
+    ReferenceKernighanLin(graph, expected);
+
+    EXPECT_NE(partition, GetProjection());
+    EXPECT_EQ(partition, expected);
+    EXPECT_LE(PartitionMetrics::GetEdgeCut(graph, partition), PartitionMetrics::GetEdgeCut(graph, GetProjection()));
+}
+
+TEST_F(BoundaryRefinementTest, FiducciaMattheysesGivesBalancedBipartitionWithSmallerCut) {
+    PartitionerOptions options;
+    const real_t accuracy = 0.05_r;
+
+    Vector<int_t> partition;
+    Uncoarser::FiducciaMattheyses<int_t, int_t>(levels[0], levels[1], coarse_partition, partition, accuracy, options);
+
+    ASSERT_EQ(partition.size(), graph.getVerticesCount());
+    for (int_t part : partition) {
+        ASSERT_TRUE(part == 0_i || part == 1_i);
+    }
+
+    EXPECT_LE(PartitionMetrics::GetAccuracy(graph, 2_i, partition), accuracy / 2.0_r + EPS);
+    EXPECT_LE(PartitionMetrics::GetEdgeCut(graph, partition), PartitionMetrics::GetEdgeCut(graph, GetProjection()));
+}
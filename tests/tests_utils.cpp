@@ -0,0 +1,65 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <numeric>
+
+#include "utils.hpp"
+
+TEST(RandomStream, SameSeedGivesSameSequence) {
+    SetRandomSeed(42);
+    Vector<int_t> first = GetRandomPermutation(100);
+    std::uint64_t first_seed = GetRandomSeed();
+
+    SetRandomSeed(42);
+    Vector<int_t> second = GetRandomPermutation(100);
+    std::uint64_t second_seed = GetRandomSeed();
+
+    EXPECT_EQ(first, second);
+    EXPECT_EQ(first_seed, second_seed);
+
+    SetRandomSeed(43);
+    EXPECT_NE(GetRandomPermutation(100), first);
+}
+
+TEST(RandomStream, PermutationContainsEveryIndex) {
+    SetRandomSeed(7);
+    Vector<int_t> permutation = GetRandomPermutation(1000);
+
+    std::sort(permutation.begin(), permutation.end());
+    Vector<int_t> expected(1000);
+    std::iota(expected.begin(), expected.end(), 0_i);
+
+    EXPECT_EQ(permutation, expected);
+}
+
+TEST(RandomStream, RandomIntIsInRange) {
+    SetRandomSeed(1);
+    Vector<int_t> hits(7, 0_i);
+    for (int_t i = 0; i < 7000; ++i) {
+        int_t value = GetRandomInt(7);
+        ASSERT_GE(value, 0_i);
+        ASSERT_LT(value, 7_i);
+        ++hits[value];
+    }
+    for (int_t count : hits) {
+        EXPECT_GT(count, 0_i);
+    }
+}
+
+TEST(RandomStream, ScopedSeedRestoresStream) {
+    SetRandomSeed(5);
+    std::uint64_t expected = GetRandomSeed();
+
+    SetRandomSeed(5);
+    {
+        ScopedRandomSeed seed(100);
+        GetRandomPermutation(50);
+    }
+    EXPECT_EQ(GetRandomSeed(), expected);
+}
+
+TEST(RandomStream, DerivedSeedsDependOnIndex) {
+    EXPECT_EQ(DeriveRandomSeed(42, 3), DeriveRandomSeed(42, 3));
+    EXPECT_NE(DeriveRandomSeed(42, 0), DeriveRandomSeed(42, 1));
+    EXPECT_NE(DeriveRandomSeed(42, 0), DeriveRandomSeed(43, 0));
+}
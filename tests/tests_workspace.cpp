@@ -0,0 +1,75 @@
+#include <gtest/gtest.h>
+
+#include "heap.hpp"
+#include "workspace.hpp"
+
+TEST(Workspace, BufferIsFilledWithValue) {
+    Workspace::Buffer<int_t> buffer(10, -1_i);
+
+    ASSERT_EQ(buffer.get().size(), 10);
+    for (int_t value : buffer.get()) {
+        EXPECT_EQ(value, -1_i);
+    }
+}
+
+TEST(Workspace, ReleasedBufferIsReused) {
+    const int_t* released_data = nullptr;
+    {
+        Workspace::Buffer<int_t> buffer(1000, 0_i);
+        released_data = buffer.get().data();
+    }
+
+    Workspace::Buffer<int_t> buffer;
+
+    EXPECT_TRUE(buffer.get().empty());
+    EXPECT_GE(buffer.get().capacity(), 1000);
+    EXPECT_EQ(buffer.get().data(), released_data);
+}
+
+TEST(Workspace, LiveBuffersAreDistinct) {
+    Workspace::Buffer<int_t> first(100, 1_i);
+    Workspace::Buffer<int_t> second(100, 2_i);
+
+    EXPECT_NE(first.get().data(), second.get().data());
+    EXPECT_EQ(first.get()[0], 1_i);
+    EXPECT_EQ(second.get()[0], 2_i);
+}
+
+TEST(Workspace, ReleasedHeapIsEmptyAndReused) {
+    using Heap = IndexedHeap<int>;
+
+    const Heap* released_heap = nullptr;
+    {
+        Workspace::HeapBuffer<Heap> buffer(100);
+        buffer.get().push(5, 3);
+        buffer.get().push(7, 42);
+        released_heap = &buffer.get();
+    }
+
+    Workspace::HeapBuffer<Heap> buffer(50);
+
+    EXPECT_EQ(&buffer.get(), released_heap);
+    EXPECT_TRUE(buffer.get().empty());
+    EXPECT_FALSE(buffer.get().contains(3));
+    EXPECT_GE(buffer.get().getCapacity(), 50);
+}
+
+TEST(Workspace, SmallerHeapIsGrownInPlace) {
+    using Heap = DaryIndexedHeap<int>;
+
+    const Heap* released_heap = nullptr;
+    {
+        Workspace::HeapBuffer<Heap> buffer(10);
+        buffer.get().push(1, 7);
+        released_heap = &buffer.get();
+    }
+
+    Workspace::HeapBuffer<Heap> buffer(1000);
+
+    EXPECT_EQ(&buffer.get(), released_heap);
+    EXPECT_TRUE(buffer.get().empty());
+    EXPECT_GE(buffer.get().getCapacity(), 1000);
+
+    buffer.get().push(3, 999);
+    EXPECT_EQ(buffer.get().top().second, 999);
+}